@@ -0,0 +1,200 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <kdeclarative/configpropertymap.h>
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KCoreConfigSkeleton>
+#include <KSharedConfig>
+#include <QTemporaryDir>
+#include <QtTest>
+
+class CountingConfigSkeleton : public KCoreConfigSkeleton
+{
+public:
+    explicit CountingConfigSkeleton(const KSharedConfig::Ptr &config)
+        : KCoreConfigSkeleton(config)
+    {
+        setCurrentGroup(QStringLiteral("General"));
+        addItemInt(QStringLiteral("Value"), m_value, 1);
+        addItemString(QStringLiteral("Text"), m_text, QStringLiteral("default"));
+        load();
+    }
+
+    int saves = 0;
+
+protected:
+    bool usrSave() override
+    {
+        ++saves;
+        return KCoreConfigSkeleton::usrSave();
+    }
+
+private:
+    int m_value;
+    QString m_text;
+};
+
+class ConfigPropertyMapTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void writeRightAway();
+    void coalesce();
+    void flush();
+    void flushOnDestruction();
+    void writeBackOriginalValue();
+    void writeBackOriginalValueDelayed();
+
+private:
+    //what's on disk, not what the skeleton has in memory
+    QVariant storedValue(const QString &key) const;
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_fileName;
+};
+
+void ConfigPropertyMapTest::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_fileName = m_dir->filePath(QStringLiteral("configpropertymaptestrc"));
+
+    //not the default values, so writing them back is visible on disk
+    KConfig config(m_fileName, KConfig::SimpleConfig);
+    KConfigGroup group = config.group("General");
+    group.writeEntry("Value", 7);
+    group.writeEntry("Text", QStringLiteral("initial"));
+    QVERIFY(config.sync());
+}
+
+QVariant ConfigPropertyMapTest::storedValue(const QString &key) const
+{
+    KConfig config(m_fileName, KConfig::SimpleConfig);
+    return config.group("General").readEntry(key, QString());
+}
+
+void ConfigPropertyMapTest::writeRightAway()
+{
+    CountingConfigSkeleton skeleton(KSharedConfig::openConfig(m_fileName, KConfig::SimpleConfig));
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+    QCOMPARE(map.writeBehindInterval(), 0);
+    QCOMPARE(map.value(QStringLiteral("Value")).toInt(), 7);
+
+    //as from QML
+    map.setProperty("Value", 3);
+    QCOMPARE(skeleton.saves, 1);
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 3);
+}
+
+void ConfigPropertyMapTest::coalesce()
+{
+    CountingConfigSkeleton skeleton(KSharedConfig::openConfig(m_fileName, KConfig::SimpleConfig));
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+    map.setWriteBehindInterval(200);
+    QCOMPARE(map.writeBehindInterval(), 200);
+
+    map.setProperty("Value", 2);
+    QTest::qWait(100);
+    //restarts the delay
+    map.setProperty("Value", 3);
+    map.setProperty("Text", QStringLiteral("changed"));
+    QTest::qWait(100);
+    map.setProperty("Value", 4);
+    QCOMPARE(skeleton.saves, 0);
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 7);
+
+    //all the keys changed meanwhile, in a single write
+    QTRY_COMPARE(skeleton.saves, 1);
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 4);
+    QCOMPARE(storedValue(QStringLiteral("Text")).toString(), QStringLiteral("changed"));
+
+    //nothing left to write
+    QTest::qWait(300);
+    QCOMPARE(skeleton.saves, 1);
+}
+
+void ConfigPropertyMapTest::flush()
+{
+    CountingConfigSkeleton skeleton(KSharedConfig::openConfig(m_fileName, KConfig::SimpleConfig));
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+    map.setWriteBehindInterval(10000);
+
+    map.setProperty("Value", 5);
+    QCOMPARE(skeleton.saves, 0);
+
+    map.flush();
+    QCOMPARE(skeleton.saves, 1);
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 5);
+
+    //going back to writing right away writes what's pending
+    map.setProperty("Value", 6);
+    map.setWriteBehindInterval(0);
+    QCOMPARE(skeleton.saves, 2);
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 6);
+}
+
+void ConfigPropertyMapTest::flushOnDestruction()
+{
+    CountingConfigSkeleton skeleton(KSharedConfig::openConfig(m_fileName, KConfig::SimpleConfig));
+    {
+        KDeclarative::ConfigPropertyMap map(&skeleton);
+        map.setWriteBehindInterval(10000);
+        map.setProperty("Value", 9);
+        map.setProperty("Text", QStringLiteral("pending"));
+        QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 7);
+    }
+
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 9);
+    QCOMPARE(storedValue(QStringLiteral("Text")).toString(), QStringLiteral("pending"));
+}
+
+void ConfigPropertyMapTest::writeBackOriginalValue()
+{
+    CountingConfigSkeleton skeleton(KSharedConfig::openConfig(m_fileName, KConfig::SimpleConfig));
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+
+    map.setProperty("Value", 5);
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 5);
+
+    //the value loaded at startup, but not the last one written
+    map.setProperty("Value", 7);
+    QCOMPARE(storedValue(QStringLiteral("Value")).toInt(), 7);
+}
+
+void ConfigPropertyMapTest::writeBackOriginalValueDelayed()
+{
+    CountingConfigSkeleton skeleton(KSharedConfig::openConfig(m_fileName, KConfig::SimpleConfig));
+    KDeclarative::ConfigPropertyMap map(&skeleton);
+    map.setWriteBehindInterval(50);
+
+    map.setProperty("Value", 5);
+    QTRY_COMPARE(storedValue(QStringLiteral("Value")).toInt(), 5);
+
+    map.setProperty("Value", 7);
+    QTRY_COMPARE(storedValue(QStringLiteral("Value")).toInt(), 7);
+    QCOMPARE(skeleton.saves, 2);
+}
+
+QTEST_MAIN(ConfigPropertyMapTest)
+
+#include "configpropertymaptest.moc"
@@ -0,0 +1,5 @@
+import QtQuick 2.0
+Item {
+    property int index: -1
+    property string label
+}
@@ -0,0 +1,9 @@
+import QtQuick 2.0
+Item {
+    width: 200
+    height: 200
+
+    Item {
+        objectName: "otherParent"
+    }
+}
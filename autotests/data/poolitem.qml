@@ -0,0 +1,12 @@
+import QtQuick 2.0
+
+Item {
+    property int value: 0
+
+    function poolReset() {
+        value = 0;
+        tracker.objectReset();
+    }
+
+    Component.onCompleted: tracker.objectCreated()
+}
@@ -0,0 +1,10 @@
+import QtQuick 2.0
+
+Item {
+    width: 100
+    height: 100
+
+    Label {
+        anchors.fill: parent
+    }
+}
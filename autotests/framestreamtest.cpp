@@ -0,0 +1,152 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <framestream.h>
+
+#include <QSignalSpy>
+#include <QThread>
+#include <QtTest>
+
+using KQuickAddons::FrameStream;
+
+class FrameStreamTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initialFrame();
+    void latestFrameWins();
+    void publishedOnce();
+    void frameOutlivesStream();
+    void producerThread();
+};
+
+static void writeFrame(FrameStream *stream, QRgb color)
+{
+    FrameStream::Frame frame = stream->beginFrame();
+    frame.image().fill(color);
+}
+
+void FrameStreamTest::initialFrame()
+{
+    FrameStream stream(QSize(4, 3));
+    QCOMPARE(stream.frameSize(), QSize(4, 3));
+    QCOMPARE(stream.currentFrame().size(), QSize(4, 3));
+    QCOMPARE(stream.currentFrame().format(), QImage::Format_RGBA8888_Premultiplied);
+    QCOMPARE(stream.currentFrame().pixel(0, 0), qRgba(0, 0, 0, 0));
+
+    //nothing published yet
+    QVERIFY(!stream.takeFrame());
+}
+
+void FrameStreamTest::latestFrameWins()
+{
+    FrameStream stream(QSize(2, 2));
+
+    writeFrame(&stream, qRgb(255, 0, 0));
+    writeFrame(&stream, qRgb(0, 255, 0));
+    writeFrame(&stream, qRgb(0, 0, 255));
+
+    QVERIFY(stream.takeFrame());
+    QCOMPARE(stream.currentFrame().pixel(1, 1), qRgb(0, 0, 255));
+
+    //the dropped frames don't come back
+    QVERIFY(!stream.takeFrame());
+    QCOMPARE(stream.currentFrame().pixel(1, 1), qRgb(0, 0, 255));
+
+    //and the current frame isn't written in by the next ones
+    {
+        FrameStream::Frame frame = stream.beginFrame();
+        frame.image().fill(qRgb(255, 255, 255));
+        QCOMPARE(stream.currentFrame().pixel(1, 1), qRgb(0, 0, 255));
+    }
+    QVERIFY(stream.takeFrame());
+    QCOMPARE(stream.currentFrame().pixel(1, 1), qRgb(255, 255, 255));
+}
+
+void FrameStreamTest::publishedOnce()
+{
+    FrameStream stream(QSize(2, 2));
+    QSignalSpy spy(&stream, &FrameStream::framePublished);
+
+    writeFrame(&stream, qRgb(255, 0, 0));
+    writeFrame(&stream, qRgb(0, 255, 0));
+    QCOMPARE(spy.count(), 1);
+
+    QVERIFY(stream.takeFrame());
+    writeFrame(&stream, qRgb(0, 0, 255));
+    QCOMPARE(spy.count(), 2);
+
+    //published explicitly, not again on destruction
+    FrameStream::Frame frame = stream.beginFrame();
+    frame.publish();
+    QVERIFY(stream.takeFrame());
+    frame.publish();
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(!stream.takeFrame());
+}
+
+void FrameStreamTest::frameOutlivesStream()
+{
+    FrameStream *stream = new FrameStream(QSize(8, 8));
+    FrameStream::Frame frame = stream->beginFrame();
+    delete stream;
+
+    frame.image().fill(qRgb(255, 0, 0));
+    QCOMPARE(frame.image().pixel(7, 7), qRgb(255, 0, 0));
+    frame.publish();
+}
+
+void FrameStreamTest::producerThread()
+{
+    const int count = 500;
+    FrameStream stream(QSize(16, 16));
+    QSignalSpy spy(&stream, &FrameStream::framePublished);
+
+    QThread *producer = QThread::create([&stream, count]() {
+        for (int i = 1; i <= count; ++i) {
+            FrameStream::Frame frame = stream.beginFrame();
+            frame.image().fill(qRgb(i % 256, i / 256, 0));
+        }
+    });
+    producer->start();
+
+    //every frame taken is a complete one, they come in order and the last one always arrives
+    int last = 0;
+    while (last < count) {
+        if (stream.takeFrame()) {
+            const QImage &image = stream.currentFrame();
+            const QRgb pixel = image.pixel(0, 0);
+            QCOMPARE(image.pixel(15, 15), pixel);
+            const int index = qRed(pixel) + qGreen(pixel) * 256;
+            QVERIFY(index > last);
+            last = index;
+        } else {
+            QThread::yieldCurrentThread();
+        }
+    }
+
+    QVERIFY(producer->wait());
+    delete producer;
+    QVERIFY(spy.count() >= 1);
+}
+
+QTEST_MAIN(FrameStreamTest)
+
+#include "framestreamtest.moc"
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <kdeclarative/kdeclarative.h>
+#include <qtest.h>
+#include <QDir>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QTemporaryDir>
+
+class KDeclarativeStartupBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void missingPlatformImportPaths();
+    void existingPlatformImportPaths();
+    void setupEngine();
+    void loadImports();
+};
+
+void KDeclarativeStartupBenchmark::missingPlatformImportPaths()
+{
+    KDeclarative::KDeclarative::setRuntimePlatform({QStringLiteral("kdeclarativetest-missing")});
+
+    QQmlEngine engine;
+    const QStringList importPaths = engine.importPathList();
+    KDeclarative::KDeclarative::setupEngine(&engine);
+
+    //none of the platformqml directories exist, nothing to look into
+    QCOMPARE(engine.importPathList(), importPaths);
+}
+
+void KDeclarativeStartupBenchmark::existingPlatformImportPaths()
+{
+    const QString target = QStringLiteral("kdeclarativetest-existing");
+    KDeclarative::KDeclarative::setRuntimePlatform({target});
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir(dir.path()).mkpath(QStringLiteral("imports")));
+    QVERIFY(QDir(dir.path()).mkpath(QStringLiteral("platformqml/") + target));
+
+    QQmlEngine engine;
+    engine.addImportPath(dir.path() + QStringLiteral("/imports"));
+    KDeclarative::KDeclarative::setupEngine(&engine);
+
+    QVERIFY(engine.importPathList().contains(dir.path() + QStringLiteral("/platformqml/") + target));
+}
+
+void KDeclarativeStartupBenchmark::setupEngine()
+{
+    KDeclarative::KDeclarative::setRuntimePlatform({QStringLiteral("kdeclarativetest-missing")});
+
+    QBENCHMARK {
+        QQmlEngine engine;
+        KDeclarative::KDeclarative::setupEngine(&engine);
+    }
+}
+
+void KDeclarativeStartupBenchmark::loadImports()
+{
+    KDeclarative::KDeclarative::setRuntimePlatform({QStringLiteral("kdeclarativetest-missing")});
+
+    //what most applets and configuration modules import
+    const QByteArray qml = "import QtQuick 2.0\n"
+                           "import QtQuick.Window 2.2\n"
+                           "import QtQuick.Layouts 1.1\n"
+                           "import QtQml.Models 2.2\n"
+                           "Item {}\n";
+
+    QBENCHMARK {
+        QQmlEngine engine;
+        KDeclarative::KDeclarative::setupEngine(&engine);
+        QQmlComponent component(&engine);
+        component.setData(qml, QUrl());
+        QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+    }
+}
+
+QTEST_MAIN(KDeclarativeStartupBenchmark)
+
+#include "kdeclarativestartupbenchmark.moc"
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <kdeclarative/qmlobject.h>
+#include <qtest.h>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QQmlEngine>
+#include <QSignalSpy>
+#include <QSet>
+#include <QTemporaryDir>
+#include "util.h"
+
+class LoadStatisticsTest : public QQmlDataTest
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase() override;
+    void phases();
+    void delayedInitialization();
+    void cachedComponent();
+    void traceFile();
+
+private:
+    QTemporaryDir m_traceDir;
+};
+
+void LoadStatisticsTest::initTestCase()
+{
+    QQmlDataTest::initTestCase();
+
+    //read when the first QmlObject is loaded
+    QVERIFY(m_traceDir.isValid());
+    qputenv("KDECLARATIVE_TRACE_FILE", QFile::encodeName(m_traceDir.filePath(QStringLiteral("trace.json"))));
+}
+
+void LoadStatisticsTest::phases()
+{
+    KDeclarative::QmlObject qmlObject;
+    QCOMPARE(qmlObject.loadStatistics().loading, qint64(-1));
+    QCOMPARE(qmlObject.loadStatistics().objectsCreated, 0);
+
+    qmlObject.setSource(testFileUrl("batchroot.qml"));
+    QVERIFY(qmlObject.rootObject());
+
+    KDeclarative::QmlObject::LoadStatistics statistics = qmlObject.loadStatistics();
+    QVERIFY(statistics.loading >= 0);
+    QVERIFY(statistics.incubation >= 0);
+    QVERIFY(statistics.initialState >= 0);
+    QVERIFY(statistics.initialState <= statistics.incubation);
+    QVERIFY(statistics.completeInitialization >= statistics.incubation);
+    QCOMPARE(statistics.objectsCreated, 1);
+    QCOMPARE(statistics.componentsLoaded, 1);
+
+    //a new component
+    QObject *object = qmlObject.createObjectFromSource(testFileUrl("batchitem.qml"));
+    QVERIFY(object);
+    statistics = qmlObject.loadStatistics();
+    QCOMPARE(statistics.objectsCreated, 2);
+    QCOMPARE(statistics.componentsLoaded, 2);
+
+    //the same one again, from the cache
+    object = qmlObject.createObjectFromSource(testFileUrl("batchitem.qml"));
+    QVERIFY(object);
+    statistics = qmlObject.loadStatistics();
+    QCOMPARE(statistics.objectsCreated, 3);
+    QCOMPARE(statistics.componentsLoaded, 2);
+
+    //a new source starts from scratch
+    qmlObject.setSource(testFileUrl("batchitem.qml"));
+    QCOMPARE(qmlObject.loadStatistics().objectsCreated, 1);
+}
+
+void LoadStatisticsTest::delayedInitialization()
+{
+    KDeclarative::QmlObject qmlObject;
+    qmlObject.setInitializationDelayed(true);
+    qmlObject.setSource(testFileUrl("batchroot.qml"));
+
+    //loaded, but nothing created yet
+    KDeclarative::QmlObject::LoadStatistics statistics = qmlObject.loadStatistics();
+    QVERIFY(statistics.loading >= 0);
+    QCOMPARE(statistics.incubation, qint64(-1));
+    QCOMPARE(statistics.completeInitialization, qint64(-1));
+    QCOMPARE(statistics.objectsCreated, 0);
+
+    QSignalSpy finishedSpy(&qmlObject, &KDeclarative::QmlObject::finished);
+    qmlObject.completeInitialization({{QStringLiteral("width"), 10}});
+    QVERIFY(qmlObject.loadStatistics().completeInitialization >= 0);
+    QVERIFY(finishedSpy.wait());
+
+    statistics = qmlObject.loadStatistics();
+    QVERIFY(statistics.incubation >= 0);
+    QVERIFY(statistics.initialState >= 0);
+    QCOMPARE(statistics.objectsCreated, 1);
+    QCOMPARE(qmlObject.rootObject()->property("width").toInt(), 10);
+}
+
+void LoadStatisticsTest::cachedComponent()
+{
+    KDeclarative::QmlObject first;
+    first.setSource(testFileUrl("batchroot.qml"));
+    QCOMPARE(first.loadStatistics().componentsLoaded, 1);
+
+    //the component is shared by the users of the engine
+    KDeclarative::QmlObject second(first.engine());
+    second.setSource(testFileUrl("batchroot.qml"));
+    QVERIFY(second.rootObject());
+    QCOMPARE(second.loadStatistics().componentsLoaded, 0);
+    QCOMPARE(second.loadStatistics().objectsCreated, 1);
+}
+
+void LoadStatisticsTest::traceFile()
+{
+    const QUrl source = testFileUrl("batchroot.qml");
+    {
+        KDeclarative::QmlObject qmlObject;
+        qmlObject.setSource(source);
+        QVERIFY(qmlObject.rootObject());
+    }
+
+    QFile file(m_traceDir.filePath(QStringLiteral("trace.json")));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    //the array is closed on exit only, what's written so far is valid up to that
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll() + "\n]", &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QVERIFY(document.isArray());
+
+    QSet<QString> phases;
+    const QJsonArray events = document.array();
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        QCOMPARE(event.value(QStringLiteral("ph")).toString(), QStringLiteral("X"));
+        QVERIFY(event.value(QStringLiteral("dur")).toDouble() >= 0);
+        if (event.value(QStringLiteral("args")).toObject().value(QStringLiteral("source")).toString() == source.toString()) {
+            phases << event.value(QStringLiteral("name")).toString();
+        }
+    }
+
+    const QSet<QString> expected{QStringLiteral("loading"), QStringLiteral("incubation"),
+                                 QStringLiteral("initialState"), QStringLiteral("completeInitialization")};
+    QCOMPARE(phases, expected);
+}
+
+QTEST_MAIN(LoadStatisticsTest)
+
+#include "loadstatisticstest.moc"
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "../src/kdeclarative/private/kioaccessmanagerfactory_p.h"
+
+#include <qtest.h>
+#include <QDir>
+#include <QNetworkReply>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+/**
+ * Stand-in HTTP server with a single resource, answering conditional requests
+ */
+class FakeHttpServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    FakeHttpServer()
+    {
+        connect(this, &QTcpServer::newConnection, this, &FakeHttpServer::handleConnection);
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1/artwork.svg").arg(serverPort()));
+    }
+
+    void setContent(const QByteArray &content, const QByteArray &etag)
+    {
+        m_content = content;
+        m_etag = etag;
+    }
+
+    //headers of the last request
+    QHash<QByteArray, QByteArray> requestHeaders;
+    int requestCount = 0;
+    int notModifiedCount = 0;
+
+private:
+    void handleConnection()
+    {
+        QTcpSocket *socket = nextPendingConnection();
+        connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+            m_buffer[socket] += socket->readAll();
+            if (!m_buffer[socket].contains("\r\n\r\n")) {
+                return;
+            }
+            respond(socket, m_buffer.take(socket));
+        });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    }
+
+    void respond(QTcpSocket *socket, const QByteArray &request)
+    {
+        ++requestCount;
+        requestHeaders.clear();
+        const QList<QByteArray> lines = request.split('\n');
+        for (int i = 1; i < lines.count(); ++i) {
+            const QByteArray line = lines.at(i).trimmed();
+            const int colon = line.indexOf(':');
+            if (colon > 0) {
+                requestHeaders.insert(line.left(colon).toLower(), line.mid(colon + 1).trimmed());
+            }
+        }
+
+        QByteArray response;
+        const QByteArray headers = "ETag: " + m_etag + "\r\n"
+                                   "Last-Modified: Mon, 01 Apr 2019 12:00:00 GMT\r\n"
+                                   //stored, but always revalidated
+                                   "Cache-Control: no-cache\r\n"
+                                   "Connection: close\r\n";
+        if (requestHeaders.value("if-none-match") == m_etag) {
+            ++notModifiedCount;
+            response = "HTTP/1.1 304 Not Modified\r\n" + headers + "\r\n";
+        } else {
+            response = "HTTP/1.1 200 OK\r\n" + headers
+                       + "Content-Type: image/svg+xml\r\n"
+                       + "Content-Length: " + QByteArray::number(m_content.size()) + "\r\n\r\n"
+                       + m_content;
+        }
+
+        socket->write(response);
+        socket->disconnectFromHost();
+    }
+
+    QByteArray m_content;
+    QByteArray m_etag;
+    QHash<QTcpSocket *, QByteArray> m_buffer;
+};
+
+class NetworkDiskCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void revalidation();
+    void persistence();
+    void disabled();
+
+private:
+    QByteArray get(QNetworkAccessManager *manager, bool *fromCache = nullptr);
+
+    FakeHttpServer m_server;
+};
+
+QByteArray NetworkDiskCacheTest::get(QNetworkAccessManager *manager, bool *fromCache)
+{
+    QNetworkReply *reply = manager->get(QNetworkRequest(m_server.url()));
+    QSignalSpy finishedSpy(reply, &QNetworkReply::finished);
+    if (!reply->isFinished()) {
+        finishedSpy.wait();
+    }
+
+    if (fromCache) {
+        *fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    }
+    const QByteArray content = reply->readAll();
+    delete reply;
+    return content;
+}
+
+void NetworkDiskCacheTest::init()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(KDeclarative::LazyKIOAccessManager::diskCacheDirectory()).removeRecursively();
+
+    if (!m_server.isListening()) {
+        QVERIFY(m_server.listen(QHostAddress::LocalHost));
+    }
+    m_server.setContent("<svg>1</svg>", "\"v1\"");
+    m_server.requestCount = 0;
+    m_server.notModifiedCount = 0;
+}
+
+void NetworkDiskCacheTest::revalidation()
+{
+    KDeclarative::LazyKIOAccessManager manager(nullptr, 1024 * 1024);
+    bool fromCache = true;
+
+    QCOMPARE(get(&manager, &fromCache), QByteArray("<svg>1</svg>"));
+    QVERIFY(!fromCache);
+    QVERIFY(!m_server.requestHeaders.contains("if-none-match"));
+
+    //unchanged: revalidated, and not downloaded again
+    QCOMPARE(get(&manager, &fromCache), QByteArray("<svg>1</svg>"));
+    QVERIFY(fromCache);
+    QCOMPARE(m_server.requestHeaders.value("if-none-match"), QByteArray("\"v1\""));
+    QVERIFY(m_server.requestHeaders.contains("if-modified-since"));
+    QCOMPARE(m_server.notModifiedCount, 1);
+
+    //changed on the server
+    m_server.setContent("<svg>2</svg>", "\"v2\"");
+    QCOMPARE(get(&manager, &fromCache), QByteArray("<svg>2</svg>"));
+    QVERIFY(!fromCache);
+    QCOMPARE(m_server.requestCount, 3);
+}
+
+void NetworkDiskCacheTest::persistence()
+{
+    {
+        KDeclarative::LazyKIOAccessManager manager(nullptr, 1024 * 1024);
+        QCOMPARE(get(&manager), QByteArray("<svg>1</svg>"));
+    }
+
+    //as after a restart of the application
+    KDeclarative::LazyKIOAccessManager manager(nullptr, 1024 * 1024);
+    bool fromCache = false;
+    QCOMPARE(get(&manager, &fromCache), QByteArray("<svg>1</svg>"));
+    QVERIFY(fromCache);
+    QCOMPARE(m_server.notModifiedCount, 1);
+}
+
+void NetworkDiskCacheTest::disabled()
+{
+    KDeclarative::LazyKIOAccessManager manager(nullptr);
+    QVERIFY(!manager.cache());
+}
+
+QTEST_MAIN(NetworkDiskCacheTest)
+
+#include "networkdiskcachetest.moc"
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <kdeclarative/qmlobjectpool.h>
+#include <qtest.h>
+#include <QPointer>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include "util.h"
+
+class PoolTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_INVOKABLE void objectCreated()
+    {
+        ++created;
+    }
+
+    Q_INVOKABLE void objectReset()
+    {
+        ++reset;
+    }
+
+    int created = 0;
+    int reset = 0;
+};
+
+class QmlObjectPoolTest : public QQmlDataTest
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void acquireRelease();
+    void releaseTwice();
+    void maximumSize();
+    void prefill();
+
+private:
+    PoolTracker m_tracker;
+};
+
+void QmlObjectPoolTest::init()
+{
+    m_tracker.created = 0;
+    m_tracker.reset = 0;
+}
+
+void QmlObjectPoolTest::acquireRelease()
+{
+    QQmlEngine engine;
+    engine.rootContext()->setContextProperty(QStringLiteral("tracker"), &m_tracker);
+    KDeclarative::QmlObjectPool pool(&engine);
+
+    QQuickItem parentItem;
+    QQuickItem *item = qobject_cast<QQuickItem *>(pool.acquire(testFileUrl("poolitem.qml")));
+    QVERIFY(item);
+    QCOMPARE(m_tracker.created, 1);
+    QVERIFY(!item->parent());
+    item->setParentItem(&parentItem);
+    item->setProperty("value", 5);
+
+    //given back: detached, hidden and reset
+    pool.release(item);
+    QCOMPARE(m_tracker.reset, 1);
+    QVERIFY(!item->parentItem());
+    QVERIFY(!item->isVisible());
+    QCOMPARE(item->property("value").toInt(), 0);
+
+    //and handed out again rather than created
+    QQuickItem *again = qobject_cast<QQuickItem *>(pool.acquire(testFileUrl("poolitem.qml")));
+    QCOMPARE(again, item);
+    QCOMPARE(m_tracker.created, 1);
+    QVERIFY(!again->parent());
+    QVERIFY(again->isVisible());
+
+    //the pool is empty again
+    QObject *other = pool.acquire(testFileUrl("poolitem.qml"));
+    QVERIFY(other);
+    QVERIFY(other != item);
+    QCOMPARE(m_tracker.created, 2);
+
+    delete item;
+    delete other;
+}
+
+void QmlObjectPoolTest::releaseTwice()
+{
+    QQmlEngine engine;
+    engine.rootContext()->setContextProperty(QStringLiteral("tracker"), &m_tracker);
+    KDeclarative::QmlObjectPool pool(&engine);
+
+    QObject *object = pool.acquire(testFileUrl("poolitem.qml"));
+    QVERIFY(object);
+    pool.release(object);
+    pool.release(object);
+    QCOMPARE(m_tracker.reset, 1);
+
+    //handed out only once
+    QObject *first = pool.acquire(testFileUrl("poolitem.qml"));
+    QObject *second = pool.acquire(testFileUrl("poolitem.qml"));
+    QCOMPARE(first, object);
+    QVERIFY(second != object);
+    QCOMPARE(m_tracker.created, 2);
+
+    delete first;
+    delete second;
+}
+
+void QmlObjectPoolTest::maximumSize()
+{
+    QQmlEngine engine;
+    engine.rootContext()->setContextProperty(QStringLiteral("tracker"), &m_tracker);
+    KDeclarative::QmlObjectPool pool(&engine);
+    QCOMPARE(pool.maximumSize(), 2);
+
+    QList<QPointer<QObject> > objects;
+    for (int i = 0; i < 3; ++i) {
+        objects << pool.acquire(testFileUrl("poolitem.qml"));
+        QVERIFY(objects.last());
+    }
+    for (QObject *object : qAsConst(objects)) {
+        pool.release(object);
+    }
+
+    //one too many, deleted rather than kept
+    QTRY_VERIFY(!objects.at(2));
+    QVERIFY(objects.at(0));
+    QVERIFY(objects.at(1));
+
+    //lowering the maximum trims what's already kept
+    pool.setMaximumSize(1);
+    QCOMPARE(pool.maximumSize(), 1);
+    QTRY_VERIFY(!objects.at(1));
+    QVERIFY(objects.at(0));
+
+    pool.setMaximumSize(0);
+    QTRY_VERIFY(!objects.at(0));
+
+    //nothing is kept anymore
+    QPointer<QObject> object = pool.acquire(testFileUrl("poolitem.qml"));
+    QVERIFY(object);
+    pool.release(object);
+    QTRY_VERIFY(!object);
+}
+
+void QmlObjectPoolTest::prefill()
+{
+    QQmlEngine engine;
+    engine.rootContext()->setContextProperty(QStringLiteral("tracker"), &m_tracker);
+    KDeclarative::QmlObjectPool pool(&engine);
+
+    //created in the idle time, not right away
+    pool.prefill(testFileUrl("poolitem.qml"), 2);
+    QCOMPARE(m_tracker.created, 0);
+    QTRY_COMPARE(m_tracker.created, 2);
+
+    //prefilled objects are reset like released ones
+    QCOMPARE(m_tracker.reset, 2);
+
+    //taken from the pool, which is topped up again
+    QObject *object = pool.acquire(testFileUrl("poolitem.qml"));
+    QVERIFY(object);
+    QCOMPARE(m_tracker.created, 2);
+    QTRY_COMPARE(m_tracker.created, 3);
+
+    //never more than asked for
+    QTest::qWait(100);
+    QCOMPARE(m_tracker.created, 3);
+
+    delete object;
+}
+
+QTEST_MAIN(QmlObjectPoolTest)
+
+#include "qmlobjectpooltest.moc"
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <kdeclarative/qmlobject.h>
+#include <qtest.h>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QPointer>
+#include <QQuickItem>
+#include <QSignalSpy>
+#include "util.h"
+
+class QmlObjectTest : public QQmlDataTest
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void createObjectsSharedProperties();
+    void createObjectsPerObjectProperties();
+    void createObjectsExplicitParent();
+    void createObjectsAsync();
+    void createObjectFromMainComponent();
+};
+
+static QVariantHash properties(int index)
+{
+    return QVariantHash{
+        {QStringLiteral("index"), index},
+        {QStringLiteral("label"), QStringLiteral("item %1").arg(index)}
+    };
+}
+
+void QmlObjectTest::createObjectsSharedProperties()
+{
+    KDeclarative::QmlObject qmlObject;
+    qmlObject.setSource(testFileUrl("batchroot.qml"));
+    QQuickItem *root = qobject_cast<QQuickItem *>(qmlObject.rootObject());
+    QVERIFY(root);
+
+    QQmlComponent component(qmlObject.engine(), testFileUrl("batchitem.qml"));
+    QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+    //a single hash is used for all the objects
+    const QList<QObject *> objects = qmlObject.createObjectsFromComponent(&component, 3, nullptr, {properties(7)});
+    QCOMPARE(objects.count(), 3);
+    for (QObject *object : objects) {
+        QQuickItem *item = qobject_cast<QQuickItem *>(object);
+        QVERIFY(item);
+        QCOMPARE(item->parentItem(), root);
+        QCOMPARE(item->property("index").toInt(), 7);
+        QCOMPARE(item->property("label").toString(), QStringLiteral("item 7"));
+    }
+
+    //the component is not taken over by the objects
+    QVERIFY(!component.parent());
+    QCOMPARE(qmlObject.loadStatistics().objectsCreated, 4);
+}
+
+void QmlObjectTest::createObjectsPerObjectProperties()
+{
+    KDeclarative::QmlObject qmlObject;
+    qmlObject.setSource(testFileUrl("batchroot.qml"));
+    QQuickItem *root = qobject_cast<QQuickItem *>(qmlObject.rootObject());
+    QVERIFY(root);
+
+    QQmlComponent component(qmlObject.engine(), testFileUrl("batchitem.qml"));
+    QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+    const QList<QObject *> objects = qmlObject.createObjectsFromComponent(&component, 3, nullptr, {properties(0), properties(1), properties(2)});
+    QCOMPARE(objects.count(), 3);
+    for (int i = 0; i < objects.count(); ++i) {
+        QCOMPARE(qobject_cast<QQuickItem *>(objects.at(i))->parentItem(), root);
+        QCOMPARE(objects.at(i)->property("index").toInt(), i);
+        QCOMPARE(objects.at(i)->property("label").toString(), QStringLiteral("item %1").arg(i));
+    }
+
+    //no properties at all
+    const QList<QObject *> defaults = qmlObject.createObjectsFromComponent(&component, 2);
+    QCOMPARE(defaults.count(), 2);
+    for (QObject *object : defaults) {
+        QCOMPARE(object->property("index").toInt(), -1);
+    }
+}
+
+void QmlObjectTest::createObjectsExplicitParent()
+{
+    KDeclarative::QmlObject qmlObject;
+    qmlObject.setSource(testFileUrl("batchroot.qml"));
+    QQuickItem *root = qobject_cast<QQuickItem *>(qmlObject.rootObject());
+    QVERIFY(root);
+    QQuickItem *otherParent = root->findChild<QQuickItem *>(QStringLiteral("otherParent"));
+    QVERIFY(otherParent);
+
+    QQmlComponent component(qmlObject.engine(), testFileUrl("batchitem.qml"));
+    QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+    //the parent given in the initial properties wins over the root object
+    QVariantHash withParent = properties(1);
+    withParent.insert(QStringLiteral("parent"), QVariant::fromValue(otherParent));
+    const QList<QObject *> objects = qmlObject.createObjectsFromComponent(&component, 2, nullptr, {properties(0), withParent});
+    QCOMPARE(objects.count(), 2);
+    QCOMPARE(qobject_cast<QQuickItem *>(objects.at(0))->parentItem(), root);
+    QCOMPARE(qobject_cast<QQuickItem *>(objects.at(1))->parentItem(), otherParent);
+}
+
+void QmlObjectTest::createObjectsAsync()
+{
+    KDeclarative::QmlObject qmlObject;
+    qmlObject.setSource(testFileUrl("batchroot.qml"));
+    QQuickItem *root = qobject_cast<QQuickItem *>(qmlObject.rootObject());
+    QVERIFY(root);
+
+    QQmlComponent component(qmlObject.engine(), testFileUrl("batchitem.qml"));
+    QVERIFY2(component.isReady(), qPrintable(component.errorString()));
+
+    QSignalSpy createdSpy(&qmlObject, &KDeclarative::QmlObject::objectsCreated);
+    qmlObject.createObjectsFromComponentAsync(&component, 3, nullptr, {properties(0), properties(1), properties(2)});
+    //nothing is created synchronously
+    QCOMPARE(createdSpy.count(), 0);
+    QVERIFY(createdSpy.wait());
+    QCOMPARE(createdSpy.count(), 1);
+
+    QCOMPARE(createdSpy.first().at(0).value<QQmlComponent *>(), &component);
+    const QList<QObject *> objects = createdSpy.first().at(1).value<QList<QObject *> >();
+    QCOMPARE(objects.count(), 3);
+    for (int i = 0; i < objects.count(); ++i) {
+        QCOMPARE(qobject_cast<QQuickItem *>(objects.at(i))->parentItem(), root);
+        QCOMPARE(objects.at(i)->property("index").toInt(), i);
+    }
+}
+
+void QmlObjectTest::createObjectFromMainComponent()
+{
+    KDeclarative::QmlObject qmlObject;
+    qmlObject.setSource(testFileUrl("batchroot.qml"));
+    QVERIFY(qmlObject.rootObject());
+
+    QPointer<QQmlComponent> mainComponent = qmlObject.mainComponent();
+    QVERIFY(mainComponent);
+    QObject *cacheParent = mainComponent->parent();
+
+    //the main component is shared through the component cache, it's not taken over by the object
+    QObject *object = qmlObject.createObjectFromComponent(mainComponent);
+    QVERIFY(object);
+    QCOMPARE(mainComponent->parent(), cacheParent);
+
+    delete object;
+    QVERIFY(mainComponent);
+    QVERIFY(mainComponent->isReady());
+    QCOMPARE(qmlObject.mainComponent(), mainComponent.data());
+}
+
+QTEST_MAIN(QmlObjectTest)
+
+#include "qmlobjecttest.moc"
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2019 The KDE Community
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <qmlpackagecache.h>
+
+#include <QDir>
+#include <QFile>
+#include <QQmlEngine>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <KPackage/PackageLoader>
+
+class QmlPackageCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void compile();
+    void fileChanged();
+    void fileAdded();
+    void diskCacheCleared();
+    void compileErrors();
+
+private:
+    KPackage::Package package() const;
+    void writeFile(const QString &fileName, const QByteArray &data);
+
+    QScopedPointer<QTemporaryDir> m_packageDir;
+};
+
+void QmlPackageCacheTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void QmlPackageCacheTest::init()
+{
+    //the manifests and the compilation units from the previous runs
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+
+    m_packageDir.reset(new QTemporaryDir);
+    QVERIFY(m_packageDir->isValid());
+
+    const QDir source(QFINDTESTDATA("data/qmlpackage"));
+    const QDir target(m_packageDir->path());
+    QVERIFY(target.mkpath(QStringLiteral("contents/ui")));
+    for (const QString &fileName : {QStringLiteral("metadata.json"), QStringLiteral("contents/ui/main.qml"), QStringLiteral("contents/ui/Label.qml")}) {
+        QVERIFY(QFile::copy(source.filePath(fileName), target.filePath(fileName)));
+    }
+
+    QVERIFY(package().isValid());
+}
+
+KPackage::Package QmlPackageCacheTest::package() const
+{
+    KPackage::Package package = KPackage::PackageLoader::self()->loadPackage(QStringLiteral("KPackage/GenericQML"));
+    package.setPath(m_packageDir->path());
+    return package;
+}
+
+void QmlPackageCacheTest::writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(QDir(m_packageDir->path()).filePath(fileName));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(data);
+}
+
+void QmlPackageCacheTest::compile()
+{
+    const KDeclarative::QmlPackageCache cache(package());
+    QVERIFY(!cache.isValid());
+
+    QQmlEngine engine;
+    QCOMPARE(cache.compile(&engine), QStringList());
+    QVERIFY(cache.isValid());
+
+    //a new engine, as in the next start of the application
+    QVERIFY(KDeclarative::QmlPackageCache(package()).isValid());
+}
+
+void QmlPackageCacheTest::fileChanged()
+{
+    QQmlEngine engine;
+    QCOMPARE(KDeclarative::QmlPackageCache(package()).compile(&engine), QStringList());
+
+    writeFile(QStringLiteral("contents/ui/Label.qml"), "import QtQuick 2.0\nRectangle { color: \"black\" }\n");
+    QVERIFY(!KDeclarative::QmlPackageCache(package()).isValid());
+}
+
+void QmlPackageCacheTest::fileAdded()
+{
+    QQmlEngine engine;
+    QCOMPARE(KDeclarative::QmlPackageCache(package()).compile(&engine), QStringList());
+
+    writeFile(QStringLiteral("contents/ui/Extra.qml"), "import QtQuick 2.0\nItem {}\n");
+    QVERIFY(!KDeclarative::QmlPackageCache(package()).isValid());
+}
+
+void QmlPackageCacheTest::diskCacheCleared()
+{
+    QQmlEngine engine;
+    QCOMPARE(KDeclarative::QmlPackageCache(package()).compile(&engine), QStringList());
+    QVERIFY(KDeclarative::QmlPackageCache(package()).isValid());
+
+    //the manifest alone is not enough
+    QVERIFY(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/qmlcache")).removeRecursively());
+    QVERIFY(!KDeclarative::QmlPackageCache(package()).isValid());
+}
+
+void QmlPackageCacheTest::compileErrors()
+{
+    writeFile(QStringLiteral("contents/ui/Broken.qml"), "import QtQuick 2.0\nItem {\n");
+
+    const KDeclarative::QmlPackageCache cache(package());
+    QQmlEngine engine;
+    const QStringList errors = cache.compile(&engine);
+    QCOMPARE(errors.count(), 1);
+    QVERIFY(errors.first().contains(QLatin1String("Broken.qml")));
+    QVERIFY(!errors.first().endsWith(QLatin1Char('\n')));
+
+    //the broken file has no compilation unit, it's compiled again next time
+    QVERIFY(!cache.isValid());
+}
+
+QTEST_MAIN(QmlPackageCacheTest)
+
+#include "qmlpackagecachetest.moc"
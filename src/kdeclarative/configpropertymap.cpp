@@ -21,6 +21,8 @@
 
 #include <QDebug>
 #include <QJSValue>
+#include <QSet>
+#include <QTimer>
 
 #include <kcoreconfigskeleton.h>
 
@@ -33,6 +35,9 @@ public:
     ConfigPropertyMapPrivate(ConfigPropertyMap *map)
         : q(map)
     {
+        writeTimer.setSingleShot(true);
+        writeTimer.setInterval(0);
+        QObject::connect(&writeTimer, &QTimer::timeout, q, &ConfigPropertyMap::flush);
     }
 
     enum LoadConfigOption {
@@ -46,6 +51,9 @@ public:
 
     ConfigPropertyMap *q;
     QPointer<KCoreConfigSkeleton> config;
+    //keys changed and not written yet
+    QSet<QString> dirtyKeys;
+    QTimer writeTimer;
 };
 
 ConfigPropertyMap::ConfigPropertyMap(KCoreConfigSkeleton *config, QObject *parent)
@@ -64,10 +72,51 @@ ConfigPropertyMap::ConfigPropertyMap(KCoreConfigSkeleton *config, QObject *paren
 
 ConfigPropertyMap::~ConfigPropertyMap()
 {
+    //writes the pending changes as well
     d->writeConfig();
     delete d;
 }
 
+void ConfigPropertyMap::setWriteBehindInterval(int msec)
+{
+    d->writeTimer.setInterval(qMax(0, msec));
+    if (msec <= 0) {
+        flush();
+    }
+}
+
+int ConfigPropertyMap::writeBehindInterval() const
+{
+    return d->writeTimer.interval();
+}
+
+void ConfigPropertyMap::flush()
+{
+    d->writeTimer.stop();
+    if (!d->config || d->dirtyKeys.isEmpty()) {
+        d->dirtyKeys.clear();
+        return;
+    }
+
+    QList<KConfigSkeletonItem *> items;
+    for (const QString &key : qAsConst(d->dirtyKeys)) {
+        if (KConfigSkeletonItem *item = d->config.data()->findItem(key)) {
+            item->setProperty(value(key));
+            items << item;
+        }
+    }
+    d->dirtyKeys.clear();
+
+    d->config.data()->blockSignals(true);
+    d->config.data()->save();
+    //items only write values different from the last ones they loaded:
+    //update those from the in memory config, instead of parsing the whole file again with read()
+    for (KConfigSkeletonItem *item : qAsConst(items)) {
+        item->readConfig(d->config.data()->config());
+    }
+    d->config.data()->blockSignals(false);
+}
+
 QVariant ConfigPropertyMap::updateValue(const QString &key, const QVariant &input)
 {
     Q_UNUSED(key);
@@ -95,6 +144,10 @@ void ConfigPropertyMapPrivate::loadConfig(ConfigPropertyMapPrivate::LoadConfigOp
 
     const auto &items = config.data()->items();
     for (KConfigSkeletonItem *item : items) {
+        //don't lose changes not written yet
+        if (dirtyKeys.contains(item->key())) {
+            continue;
+        }
         q->insert(item->key(), item->property());
         if (option == EmitValueChanged) {
             emit q->valueChanged(item->key(), item->property());
@@ -112,6 +165,9 @@ void ConfigPropertyMapPrivate::writeConfig()
         item->setProperty(q->value(item->key()));
     }
 
+    dirtyKeys.clear();
+    writeTimer.stop();
+
     config.data()->blockSignals(true);
     config.data()->save();
     config.data()->blockSignals(false);
@@ -119,15 +175,17 @@ void ConfigPropertyMapPrivate::writeConfig()
 
 void ConfigPropertyMapPrivate::writeConfigValue(const QString &key, const QVariant &value)
 {
-    KConfigSkeletonItem *item = config.data()->findItem(key);
-    if (item) {
-        item->setProperty(value);
-        config.data()->blockSignals(true);
-        config.data()->save();
-        //why read? read will update KConfigSkeletonItem::mLoadedValue,
-        //allowing a write operation to be performed next time
-        config.data()->read();
-        config.data()->blockSignals(false);
+    Q_UNUSED(value);
+    if (!config || !config.data()->findItem(key)) {
+        return;
+    }
+
+    dirtyKeys.insert(key);
+    if (writeTimer.interval() > 0) {
+        //restarted at every change, written once they settle
+        writeTimer.start();
+    } else {
+        q->flush();
     }
 }
 
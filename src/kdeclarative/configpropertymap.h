@@ -51,6 +51,31 @@ public:
      */
     Q_INVOKABLE bool isImmutable(const QString &key) const;
 
+    /**
+     * Sets for how long changes are held before being written to the configuration.
+     * Every change restarts the delay, so a value changing continuously,
+     * such as one bound to a slider, is written once it settles, together with
+     * the other keys changed in the meantime.
+     * Pending changes are written as well when the map is destroyed.
+     * By default every change is written right away.
+     *
+     * @param msec the delay in milliseconds, 0 to write changes right away
+     * @since 5.57
+     */
+    void setWriteBehindInterval(int msec);
+
+    /**
+     * @return for how long changes are held before being written, in milliseconds
+     * @since 5.57
+     */
+    int writeBehindInterval() const;
+
+    /**
+     * Writes the pending changes to the configuration now
+     * @since 5.57
+     */
+    Q_INVOKABLE void flush();
+
 protected:
     QVariant updateValue(const QString &key, const QVariant &input) override;
 private:
@@ -25,6 +25,9 @@
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 #include <QQmlComponent>
 #include <QQmlContext>
 #include <QQmlEngine>
@@ -37,6 +40,55 @@
 namespace KDeclarative {
 
 QStringList KDeclarativePrivate::s_runtimePlatform;
+bool KDeclarativePrivate::s_runtimePlatformRead = false;
+qint64 KDeclarativePrivate::s_networkDiskCacheSize = 0;
+
+//platform directories rarely exist for most of the import paths, and each one added
+//is probed for every import afterwards: only add the existing ones, checked once as long
+//as the engines have the same import paths. New ones may come with new directories
+static bool platformImportPathExists(const QStringList &importPaths, const QString &path)
+{
+    static QMutex s_mutex;
+    static QStringList s_importPaths;
+    static QHash<QString, bool> s_existingPaths;
+
+    QMutexLocker locker(&s_mutex);
+    if (importPaths != s_importPaths) {
+        s_importPaths = importPaths;
+        s_existingPaths.clear();
+    }
+
+    auto it = s_existingPaths.constFind(path);
+    if (it == s_existingPaths.constEnd()) {
+        it = s_existingPaths.insert(path, QFileInfo(path).isDir());
+    }
+    return it.value();
+}
+
+//not any KLocalizedContext, applications can have their own
+static QString sharedContextObjectName()
+{
+    return QStringLiteral("_kdeclarative_contextObject");
+}
+
+//context objects only depend on the translation domain,
+//share them among all the users of an engine instead of having one each
+static KLocalizedContext *sharedContextObject(QQmlEngine *engine, const QString &translationDomain)
+{
+    const QString name = sharedContextObjectName();
+
+    const auto contextObjects = engine->findChildren<KLocalizedContext *>(name, Qt::FindDirectChildrenOnly);
+    for (KLocalizedContext *contextObject : contextObjects) {
+        if (contextObject->translationDomain() == translationDomain) {
+            return contextObject;
+        }
+    }
+
+    KLocalizedContext *contextObject = new KLocalizedContext(engine);
+    contextObject->setObjectName(name);
+    contextObject->setTranslationDomain(translationDomain);
+    return contextObject;
+}
 
 KDeclarativePrivate::KDeclarativePrivate()
     : contextObj(nullptr)
@@ -82,9 +134,7 @@ void KDeclarative::setupContext()
 {
     /*Create a context object for the root qml context.
       in this way we can register global functions, in this case the i18n() family*/
-    if (!d->contextObj) {
-        d->contextObj = new KLocalizedContext(d->declarativeEngine.data());
-    }
+    d->contextObj = sharedContextObject(d->declarativeEngine.data(), d->translationDomain);
 
     //If the engine is in a qmlObject take the qmlObject rootContext instead of the engine one.
     if (d->qmlObj) {
@@ -92,10 +142,6 @@ void KDeclarative::setupContext()
     } else {
         d->declarativeEngine.data()->rootContext()->setContextObject(d->contextObj);
     }
-
-    if (!d->translationDomain.isNull()) {
-        d->contextObj->setTranslationDomain(d->translationDomain);
-    }
 }
 
 void KDeclarative::setupEngine(QQmlEngine *engine)
@@ -104,7 +150,7 @@ void KDeclarative::setupEngine(QQmlEngine *engine)
     QQmlNetworkAccessManagerFactory *factory = engine->networkAccessManagerFactory();
     engine->setNetworkAccessManagerFactory(nullptr);
     delete factory;
-    engine->setNetworkAccessManagerFactory(new KIOAccessManagerFactory());
+    engine->setNetworkAccessManagerFactory(new KIOAccessManagerFactory(KDeclarativePrivate::s_networkDiskCacheSize));
 
     /* Tell the engine to search for platform-specific imports first
        (so it will "win" in import name resolution).
@@ -119,8 +165,10 @@ void KDeclarative::setupEngine(QQmlEngine *engine)
         it.toBack();
         while (it.hasPrevious()) {
             QString path = it.previous();
-            path = path.left(path.lastIndexOf(QLatin1Char('/')));
-            engine->addImportPath(path + QStringLiteral("/platformqml/") + target);
+            path = path.left(path.lastIndexOf(QLatin1Char('/'))) + QStringLiteral("/platformqml/") + target;
+            if (platformImportPathExists(pluginPathList, path)) {
+                engine->addImportPath(path);
+            }
         }
     }
 
@@ -131,9 +179,26 @@ void KDeclarative::setupEngine(QQmlEngine *engine)
 void KDeclarative::setTranslationDomain(const QString &translationDomain)
 {
     d->translationDomain = translationDomain;
-    if (d->contextObj) {
-        d->contextObj->setTranslationDomain(d->translationDomain);
+    if (!d->contextObj) {
+        return;
     }
+
+    //already one of our own
+    if (d->contextObj->objectName() != sharedContextObjectName()) {
+        d->contextObj->setTranslationDomain(translationDomain);
+        return;
+    }
+
+    //the context object is shared with the other users of the engine, changing its domain
+    //would change theirs: switch to one of our own, where ours is still the one in use
+    KLocalizedContext *contextObject = new KLocalizedContext(d->declarativeEngine.data());
+    contextObject->setTranslationDomain(translationDomain);
+
+    QQmlContext *context = d->qmlObj ? d->qmlObj->rootContext() : d->declarativeEngine.data()->rootContext();
+    if (context->contextObject() == d->contextObj) {
+        context->setContextObject(contextObject);
+    }
+    d->contextObj = contextObject;
 }
 
 QString KDeclarative::translationDomain() const
@@ -165,7 +230,8 @@ QString KDeclarative::componentsTarget()
 
 QStringList KDeclarative::runtimePlatform()
 {
-    if (KDeclarativePrivate::s_runtimePlatform.isEmpty()) {
+    if (!KDeclarativePrivate::s_runtimePlatformRead) {
+        KDeclarativePrivate::s_runtimePlatformRead = true;
         const QString env = QString::fromLocal8Bit(getenv("PLASMA_PLATFORM"));
         KDeclarativePrivate::s_runtimePlatform = QStringList(env.split(QLatin1Char(':'), QString::SkipEmptyParts));
         if (KDeclarativePrivate::s_runtimePlatform.isEmpty()) {
@@ -177,9 +243,20 @@ QStringList KDeclarative::runtimePlatform()
     return KDeclarativePrivate::s_runtimePlatform;
 }
 
+void KDeclarative::setNetworkDiskCacheSize(qint64 size)
+{
+    KDeclarativePrivate::s_networkDiskCacheSize = qMax<qint64>(0, size);
+}
+
+qint64 KDeclarative::networkDiskCacheSize()
+{
+    return KDeclarativePrivate::s_networkDiskCacheSize;
+}
+
 void KDeclarative::setRuntimePlatform(const QStringList &platform)
 {
     KDeclarativePrivate::s_runtimePlatform = platform;
+    KDeclarativePrivate::s_runtimePlatformRead = true;
 }
 
 }
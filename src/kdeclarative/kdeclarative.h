@@ -62,6 +62,8 @@ public:
 
     /**
      * Call this after setDeclarativeEngine to set the i18n global functions.
+     * The object providing them is shared by all the users of the engine
+     * with the same translation domain.
      *
      * @since 5.45
      * @sa setupEngine
@@ -84,6 +86,10 @@ public:
      * in an application there is no need to set the translation domain as the application's
      * domain can be used.
      *
+     * Called after setupContext(), the object providing the i18n functions isn't shared
+     * anymore: this instance gets one of its own, leaving the other users of the engine
+     * with the previous domain.
+     *
      * @param translationDomain The translation domain to be used for i18n calls.
      * @since 5.0
      */
@@ -117,6 +123,24 @@ public:
      */
     static void setRuntimePlatform(const QStringList &platform);
 
+    /**
+     * Sets the maximum size of a persistent cache for the remote resources,
+     * such as images, loaded by the engines set up from now on with setupEngine().
+     * Cached resources are revalidated with the server, and only downloaded
+     * again if they changed.
+     * The cache is disabled by default.
+     *
+     * @param size maximum size of the cache in bytes, 0 to disable it
+     * @since 5.57
+     */
+    static void setNetworkDiskCacheSize(qint64 size);
+
+    /**
+     * @return the maximum size of the cache of remote resources, 0 if disabled
+     * @since 5.57
+     */
+    static qint64 networkDiskCacheSize();
+
     /**
      * @return the QML components target, based on the runtime platform. e.g. touch or desktop
      * @since 4.10
@@ -0,0 +1,117 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "incubationcontroller_p.h"
+
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQuickWindow>
+#include <QScreen>
+#include <QTimer>
+
+namespace KDeclarative {
+
+//used when there is no window to follow the frames of
+static const int s_sliceInterval = 16;
+static const int s_sliceBudget = 5;
+
+static QQuickWindow *incubationWindow()
+{
+    if (QQuickWindow *window = qobject_cast<QQuickWindow *>(QGuiApplication::focusWindow())) {
+        return window;
+    }
+
+    const auto windows = QGuiApplication::topLevelWindows();
+    for (QWindow *window : windows) {
+        QQuickWindow *quickWindow = qobject_cast<QQuickWindow *>(window);
+        if (quickWindow && quickWindow->isExposed()) {
+            return quickWindow;
+        }
+    }
+
+    return nullptr;
+}
+
+void IncubationController::install(QQmlEngine *engine)
+{
+    if (!engine->incubationController()) {
+        //the engine doesn't take ownership, but outlives its children
+        engine->setIncubationController(new IncubationController(engine));
+    }
+}
+
+IncubationController::IncubationController(QObject *parent)
+    : QObject(parent),
+      m_timer(new QTimer(this))
+{
+    m_timer->setInterval(s_sliceInterval);
+    connect(m_timer, &QTimer::timeout, this, &IncubationController::incubateSlice);
+}
+
+void IncubationController::incubatingObjectCountChanged(int incubatingObjectCount)
+{
+    if (incubatingObjectCount == 0) {
+        stop();
+        return;
+    }
+
+    if (m_frameConnection || m_timer->isActive()) {
+        return;
+    }
+
+    m_window = incubationWindow();
+    if (m_window) {
+        //frameSwapped comes from the render thread
+        m_frameConnection = connect(m_window.data(), &QQuickWindow::frameSwapped,
+                                    this, &IncubationController::incubateFrame, Qt::QueuedConnection);
+        m_window->update();
+    } else {
+        m_timer->start();
+    }
+}
+
+void IncubationController::incubateFrame()
+{
+    if (!m_window || !m_window->isExposed()) {
+        stop();
+        m_timer->start();
+        return;
+    }
+
+    const qreal refreshRate = m_window->screen() ? m_window->screen()->refreshRate() : 60;
+    incubateFor(qMax(1, int(1000 / refreshRate / 3)));
+
+    if (incubatingObjectCount() > 0) {
+        m_window->update();
+    }
+}
+
+void IncubationController::incubateSlice()
+{
+    incubateFor(s_sliceBudget);
+}
+
+void IncubationController::stop()
+{
+    disconnect(m_frameConnection);
+    m_frameConnection = QMetaObject::Connection();
+    m_timer->stop();
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef INCUBATIONCONTROLLER_P_H
+#define INCUBATIONCONTROLLER_P_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQmlIncubationController>
+
+class QQmlEngine;
+class QQuickWindow;
+class QTimer;
+
+namespace KDeclarative {
+
+/**
+ * Incubation controller for engines which don't have one yet,
+ * used for delayed QmlObject initialization.
+ *
+ * While a window is being shown, incubation happens after each frame for a
+ * third of the frame time, asking for new frames as long as there is work
+ * left. Without a window, incubation is done in short slices from a timer,
+ * leaving the event loop some time in between.
+ */
+class IncubationController : public QObject, public QQmlIncubationController
+{
+public:
+    /**
+     * Installs a controller on @p engine, unless it has one already
+     */
+    static void install(QQmlEngine *engine);
+
+protected:
+    void incubatingObjectCountChanged(int incubatingObjectCount) override;
+
+private:
+    explicit IncubationController(QObject *parent);
+    void incubateFrame();
+    void incubateSlice();
+    void stop();
+
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_frameConnection;
+    QTimer *m_timer;
+};
+
+}
+
+#endif
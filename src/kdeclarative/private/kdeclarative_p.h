@@ -36,6 +36,9 @@ public:
     QPointer<QQmlEngine> declarativeEngine;
     QString translationDomain;
     static QStringList s_runtimePlatform;
+    //whether s_runtimePlatform has been read from the environment and the config, empty or not
+    static bool s_runtimePlatformRead;
+    static qint64 s_networkDiskCacheSize;
     QPointer<KLocalizedContext> contextObj;
     QPointer<QmlObject> qmlObj;
 };
@@ -17,33 +17,102 @@
 
 #include "kiconprovider_p.h"
 
+#include <QImage>
 #include <QPixmap>
+#include <QQuickWindow>
 #include <QSize>
 #include <QIcon>
+#include <QMutex>
 #include <kiconloader.h>
 #include <kiconeffect.h>
 
 namespace KDeclarative {
 
+Q_GLOBAL_STATIC(QMutex, s_rasterizationMutex)
+
+KIconImageCache::KIconImageCache()
+{
+    //in bytes
+    m_images.setMaxCost(16 * 1024 * 1024);
+}
+
+QString KIconImageCache::key(const QString &id, const QSize &requestedSize)
+{
+    return id + QLatin1Char('@') + QString::number(requestedSize.width()) + QLatin1Char('x') + QString::number(requestedSize.height());
+}
+
+bool KIconImageCache::find(const QString &key, QImage *image)
+{
+    QMutexLocker locker(&m_mutex);
+    if (QImage *cached = m_images.object(key)) {
+        *image = *cached;
+        return true;
+    }
+    return false;
+}
+
+void KIconImageCache::insert(const QString &key, const QImage &image)
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.insert(key, new QImage(image), qMax<int>(1, image.sizeInBytes()));
+}
+
+void KIconImageCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.clear();
+}
+
+
+
 KIconProvider::KIconProvider()
-    : QQuickImageProvider(QQuickImageProvider::Pixmap)
+    : QQuickAsyncImageProvider()
 {
+    //a single background thread: neither QIcon nor KIconLoader are thread safe and the
+    //rasterizations are serialized anyways, the point is keeping them out of the requesting thread
+    m_pool.setMaxThreadCount(1);
+
+    //new theme or new effect settings: everything we have is outdated
+    QObject::connect(KIconLoader::global(), &KIconLoader::iconLoaderSettingsChanged, &m_iconLoaderContext, [this]() {
+        m_cache.clear();
+    });
+    QObject::connect(KIconLoader::global(), &KIconLoader::iconChanged, &m_iconLoaderContext, [this]() {
+        m_cache.clear();
+    });
 }
 
-QPixmap KIconProvider::requestPixmap(const QString &id, QSize *size, const QSize &requestedSize)
+KIconProvider::~KIconProvider()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QQuickImageResponse *KIconProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    return new KIconImageResponse(id, requestedSize, &m_pool, &m_cache);
+}
+
+QImage KIconProvider::iconImage(const QString &id, const QSize &requestedSize)
 {
     // We need to handle QIcon::state
     const QStringList source = id.split(QLatin1Char('/'));
 
+    //the theme lookup and the rasterization happen in pixmap(), through the icon engine and
+    //KIconLoader: the whole sequence is serialized between the providers of all engines.
+    //Icons loaded in the gui thread meanwhile aren't covered, KIconLoader isn't thread safe
+    QMutexLocker locker(s_rasterizationMutex());
+
+    const QIcon icon = QIcon::fromTheme(source.at(0));
+
     QPixmap pixmap;
     if (requestedSize.isValid()) {
-        pixmap = QIcon::fromTheme(source.at(0)).pixmap(requestedSize);
-    } else if (size->isValid()) {
-        pixmap = QIcon::fromTheme(source.at(0)).pixmap(*size);
+        pixmap = icon.pixmap(requestedSize);
     } else {
-        pixmap = QIcon::fromTheme(source.at(0)).pixmap(IconSize(KIconLoader::Desktop));
+        pixmap = icon.pixmap(IconSize(KIconLoader::Desktop));
     }
 
+    QImage image = pixmap.toImage();
+
     if (source.size() == 2) {
         KIconEffect *effect = KIconLoader::global()->iconEffect();
         const QString state(source.at(1));
@@ -58,15 +127,104 @@ QPixmap KIconProvider::requestPixmap(const QString &id, QSize *size, const QSize
         }
 
         // apply the effect for state
-        pixmap = effect->apply(pixmap, KIconLoader::Desktop, finalState);
+        image = effect->apply(image, KIconLoader::Desktop, finalState);
+    }
+
+    locker.unlock();
+
+    //what the scene graph uploads as is, so it's converted once here rather than per texture
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+
+
+KIconTextureFactory::KIconTextureFactory(const QImage &image)
+    : m_image(image)
+{
+}
+
+QSGTexture *KIconTextureFactory::createTexture(QQuickWindow *window) const
+{
+    return window->createTextureFromImage(m_image, QQuickWindow::TextureCanUseAtlas);
+}
+
+QSize KIconTextureFactory::textureSize() const
+{
+    return m_image.size();
+}
+
+int KIconTextureFactory::textureByteCount() const
+{
+    return m_image.sizeInBytes();
+}
+
+QImage KIconTextureFactory::image() const
+{
+    return m_image;
+}
+
+
+
+KIconImageRunnable::KIconImageRunnable(const QString &id, const QSize &requestedSize, KIconImageCache *cache, const QSharedPointer<QAtomicInt> &cancelled)
+    : m_id(id),
+      m_requestedSize(requestedSize),
+      m_cache(cache),
+      m_cancelled(cancelled)
+{
+}
+
+void KIconImageRunnable::run()
+{
+    //the delegate asking for it may be long gone
+    if (m_cancelled->load()) {
+        emit done(QImage());
+        return;
+    }
+
+    const QImage image = KIconProvider::iconImage(m_id, m_requestedSize);
+    if (!image.isNull()) {
+        m_cache->insert(KIconImageCache::key(m_id, m_requestedSize), image);
+    }
+    emit done(image);
+}
+
+
+
+KIconImageResponse::KIconImageResponse(const QString &id, const QSize &requestedSize, QThreadPool *pool, KIconImageCache *cache)
+    : m_cancelled(new QAtomicInt(0))
+{
+    QImage image;
+    if (cache->find(KIconImageCache::key(id, requestedSize), &image)) {
+        //finished() can't be emitted before the engine gets the chance to connect to it
+        QMetaObject::invokeMethod(this, "handleDone", Qt::QueuedConnection, Q_ARG(QImage, image));
+        return;
     }
 
-    if (!pixmap.isNull() && size) {
-        *size = pixmap.size();
+    KIconImageRunnable *runnable = new KIconImageRunnable(id, requestedSize, cache, m_cancelled);
+    connect(runnable, &KIconImageRunnable::done, this, &KIconImageResponse::handleDone, Qt::QueuedConnection);
+    pool->start(runnable);
+}
+
+QQuickTextureFactory *KIconImageResponse::textureFactory() const
+{
+    if (m_image.isNull()) {
+        return nullptr;
     }
+    return new KIconTextureFactory(m_image);
+}
 
-    return pixmap;
+void KIconImageResponse::cancel()
+{
+    //finished() still comes once the runnable is done, the engine relies on it to clean up
+    m_cancelled->store(1);
+}
+
+void KIconImageResponse::handleDone(const QImage &image)
+{
+    m_image = image;
+    emit finished();
 }
 
 }
 
+#include "moc_kiconprovider_p.cpp"
@@ -18,16 +18,117 @@
 #ifndef ICON_PROVIDER_H
 #define ICON_PROVIDER_H
 
-#include <QQuickImageProvider>
+#include <QCache>
+#include <QMutex>
+#include <QQuickAsyncImageProvider>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
 
 namespace KDeclarative {
 
-class KIconProvider : public QQuickImageProvider
+/**
+ * LRU cache of the final icon images, effects included, with a byte budget.
+ * Shared by the request thread and the rasterization threads.
+ */
+class KIconImageCache
+{
+public:
+    KIconImageCache();
+
+    static QString key(const QString &id, const QSize &requestedSize);
+
+    bool find(const QString &key, QImage *image);
+    void insert(const QString &key, const QImage &image);
+    void clear();
+
+private:
+    QMutex m_mutex;
+    QCache<QString, QImage> m_images;
+};
+
+/**
+ * Provides the image://icon/ urls, rasterizing the icons in a single
+ * background thread so that the requesting thread never blocks on them.
+ * Results are cached until the icon theme or its settings change.
+ */
+class KIconProvider : public QQuickAsyncImageProvider
 {
 
 public:
     KIconProvider();
-    QPixmap requestPixmap(const QString &id, QSize *size, const QSize &requestedSize) override;
+    ~KIconProvider() override;
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    /**
+     * Rasterizes the icon described by @p id, applying the effect for the
+     * state it may contain (e.g. "edit-copy/active").
+     */
+    static QImage iconImage(const QString &id, const QSize &requestedSize);
+
+private:
+    QThreadPool m_pool;
+    KIconImageCache m_cache;
+    //the image providers are QObjects only since Qt 5.15: context of the
+    //connections to KIconLoader, disconnecting them when the provider goes away
+    QObject m_iconLoaderContext;
+};
+
+/**
+ * Hands the cached image itself to the engine: it's already in the format the
+ * scene graph uploads, and the image data is shared with the cache rather than
+ * copied for each response.
+ */
+class KIconTextureFactory : public QQuickTextureFactory
+{
+public:
+    explicit KIconTextureFactory(const QImage &image);
+
+    QSGTexture *createTexture(QQuickWindow *window) const override;
+    QSize textureSize() const override;
+    int textureByteCount() const override;
+    QImage image() const override;
+
+private:
+    const QImage m_image;
+};
+
+class KIconImageRunnable : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    KIconImageRunnable(const QString &id, const QSize &requestedSize, KIconImageCache *cache, const QSharedPointer<QAtomicInt> &cancelled);
+
+    void run() override;
+
+Q_SIGNALS:
+    void done(const QImage &image);
+
+private:
+    const QString m_id;
+    const QSize m_requestedSize;
+    KIconImageCache *m_cache;
+    QSharedPointer<QAtomicInt> m_cancelled;
+};
+
+class KIconImageResponse : public QQuickImageResponse
+{
+    Q_OBJECT
+
+public:
+    KIconImageResponse(const QString &id, const QSize &requestedSize, QThreadPool *pool, KIconImageCache *cache);
+
+    QQuickTextureFactory *textureFactory() const override;
+    void cancel() override;
+
+private Q_SLOTS:
+    void handleDone(const QImage &image);
+
+private:
+    QImage m_image;
+    QSharedPointer<QAtomicInt> m_cancelled;
 };
 
 }
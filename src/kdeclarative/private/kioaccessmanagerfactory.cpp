@@ -20,10 +20,163 @@
 #include "kioaccessmanagerfactory_p.h"
 #include <kio/accessmanager.h>
 
+#include <QAbstractNetworkCache>
+#include <QHash>
+#include <QMutex>
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSharedPointer>
+#include <QStandardPaths>
+
 namespace KDeclarative {
 
-KIOAccessManagerFactory::KIOAccessManagerFactory()
-    : QQmlNetworkAccessManagerFactory()
+static bool isLocal(const QUrl &url)
+{
+    return url.isLocalFile() || url.scheme() == QLatin1String("qrc") || url.scheme().isEmpty();
+}
+
+static bool isHttp(const QUrl &url)
+{
+    return url.scheme() == QLatin1String("http") || url.scheme() == QLatin1String("https");
+}
+
+/*
+ * The engine creates an access manager per thread using the network (type loader,
+ * image reader, XMLHttpRequest...), and the QNetworkDiskCache instances of each would
+ * keep track of size and expiration on their own, removing each other's files:
+ * all of them go through the same QNetworkDiskCache for a directory, under its lock.
+ */
+class SharedNetworkDiskCache : public QAbstractNetworkCache
+{
+public:
+    SharedNetworkDiskCache(const QString &directory, qint64 maximumSize, QObject *parent)
+        : QAbstractNetworkCache(parent)
+    {
+        static QMutex s_cachesMutex;
+        static QHash<QString, QWeakPointer<Cache>> s_caches;
+
+        QMutexLocker locker(&s_cachesMutex);
+        m_cache = s_caches.value(directory).toStrongRef();
+        if (!m_cache) {
+            m_cache.reset(new Cache);
+            m_cache->diskCache.setCacheDirectory(directory);
+            s_caches.insert(directory, m_cache);
+        }
+
+        QMutexLocker cacheLocker(&m_cache->mutex);
+        m_cache->diskCache.setMaximumCacheSize(qMax(maximumSize, m_cache->diskCache.maximumCacheSize()));
+    }
+
+    QNetworkCacheMetaData metaData(const QUrl &url) override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        return m_cache->diskCache.metaData(url);
+    }
+
+    void updateMetaData(const QNetworkCacheMetaData &metaData) override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        m_cache->diskCache.updateMetaData(metaData);
+    }
+
+    QIODevice *data(const QUrl &url) override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        return m_cache->diskCache.data(url);
+    }
+
+    bool remove(const QUrl &url) override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        return m_cache->diskCache.remove(url);
+    }
+
+    qint64 cacheSize() const override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        return m_cache->diskCache.cacheSize();
+    }
+
+    QIODevice *prepare(const QNetworkCacheMetaData &metaData) override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        return m_cache->diskCache.prepare(metaData);
+    }
+
+    void insert(QIODevice *device) override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        m_cache->diskCache.insert(device);
+    }
+
+    void clear() override
+    {
+        QMutexLocker locker(&m_cache->mutex);
+        m_cache->diskCache.clear();
+    }
+
+private:
+    //not a QObject child of anything, so it can be used from the threads of all the managers
+    struct Cache {
+        QMutex mutex;
+        QNetworkDiskCache diskCache;
+    };
+
+    QSharedPointer<Cache> m_cache;
+};
+
+LazyKIOAccessManager::LazyKIOAccessManager(QObject *parent, qint64 diskCacheSize)
+    : QNetworkAccessManager(parent)
+{
+    if (diskCacheSize > 0) {
+        setCache(new SharedNetworkDiskCache(diskCacheDirectory(), diskCacheSize, this));
+    }
+}
+
+QString LazyKIOAccessManager::diskCacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/qmlnetworkcache");
+}
+
+QNetworkAccessManager *LazyKIOAccessManager::kioAccessManager()
+{
+    if (!m_kioAccessManager) {
+        //no need to forward its finished(): the replies returned by createRequest()
+        //are reparented to this manager, which emits finished() for them itself
+        m_kioAccessManager = new KIO::AccessManager(this);
+    }
+    return m_kioAccessManager;
+}
+
+QNetworkReply *LazyKIOAccessManager::createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData)
+{
+    //the file and resource backends of Qt don't need any job,
+    //and its HTTP backend is the one using the disk cache
+    if (isLocal(request.url()) || (cache() && isHttp(request.url()))) {
+        return QNetworkAccessManager::createRequest(op, request, outgoingData);
+    }
+
+    QNetworkAccessManager *manager = kioAccessManager();
+    switch (op) {
+    case HeadOperation:
+        return manager->head(request);
+    case GetOperation:
+        return manager->get(request);
+    case PutOperation:
+        return manager->put(request, outgoingData);
+    case PostOperation:
+        return manager->post(request, outgoingData);
+    case DeleteOperation:
+        return manager->deleteResource(request);
+    default:
+        return manager->sendCustomRequest(request, request.attribute(QNetworkRequest::CustomVerbAttribute).toByteArray(), outgoingData);
+    }
+}
+
+KIOAccessManagerFactory::KIOAccessManagerFactory(qint64 diskCacheSize)
+    : QQmlNetworkAccessManagerFactory(),
+      m_diskCacheSize(diskCacheSize)
 {
 }
 
@@ -33,7 +186,7 @@ KIOAccessManagerFactory::~KIOAccessManagerFactory()
 
 QNetworkAccessManager *KIOAccessManagerFactory::create(QObject *parent)
 {
-    return new KIO::AccessManager(parent);
+    return new LazyKIOAccessManager(parent, m_diskCacheSize);
 }
 
 }
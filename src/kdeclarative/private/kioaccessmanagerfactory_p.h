@@ -20,16 +20,51 @@
 #ifndef KIOACCESSMANAGERFACTORY_H
 #define KIOACCESSMANAGERFACTORY_H
 
+#include <QNetworkAccessManager>
+#include <QPointer>
 #include <QQmlNetworkAccessManagerFactory>
 
 namespace KDeclarative {
 
+/**
+ * Reads local files and resources directly, and creates a KIO::AccessManager
+ * only when a request for another scheme comes.
+ *
+ * With a disk cache, HTTP is handled by Qt instead, which stores the replies
+ * in a QNetworkDiskCache and revalidates them with their ETag and Last-Modified
+ * headers, across restarts of the application.
+ */
+class LazyKIOAccessManager : public QNetworkAccessManager
+{
+public:
+    /**
+     * @param diskCacheSize maximum size of the disk cache in bytes, 0 for none
+     */
+    explicit LazyKIOAccessManager(QObject *parent, qint64 diskCacheSize = 0);
+
+    /**
+     * @returns the directory of the disk cache, shared by all the access managers of the application
+     */
+    static QString diskCacheDirectory();
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData) override;
+
+private:
+    QNetworkAccessManager *kioAccessManager();
+
+    QPointer<QNetworkAccessManager> m_kioAccessManager;
+};
+
 class KIOAccessManagerFactory : public QQmlNetworkAccessManagerFactory
 {
 public:
-    KIOAccessManagerFactory();
+    explicit KIOAccessManagerFactory(qint64 diskCacheSize = 0);
     ~KIOAccessManagerFactory();
     QNetworkAccessManager *create(QObject *parent) override;
+
+private:
+    const qint64 m_diskCacheSize;
 };
 
 }
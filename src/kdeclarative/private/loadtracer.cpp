@@ -0,0 +1,106 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "loadtracer_p.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <QUrl>
+
+#include <qdebug.h>
+
+namespace KDeclarative {
+
+class TraceFile
+{
+public:
+    TraceFile()
+    {
+        clock.start();
+
+        const QString fileName = QFile::decodeName(qgetenv("KDECLARATIVE_TRACE_FILE"));
+        if (fileName.isEmpty()) {
+            return;
+        }
+
+        file.setFileName(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "Could not open the trace file" << fileName << file.errorString();
+            return;
+        }
+        file.write("[\n");
+        file.flush();
+    }
+
+    ~TraceFile()
+    {
+        //viewers accept an unterminated array, which is all there is if the process crashes,
+        //but other tools need valid JSON
+        if (file.isOpen()) {
+            file.write("\n]\n");
+        }
+    }
+
+    QElapsedTimer clock;
+    QMutex mutex;
+    QFile file;
+    bool empty = true;
+};
+
+Q_GLOBAL_STATIC(TraceFile, s_traceFile)
+
+qint64 LoadTracer::now()
+{
+    return s_traceFile->clock.nsecsElapsed();
+}
+
+void LoadTracer::trace(const char *phase, const QUrl &source, qint64 start, qint64 end)
+{
+    TraceFile *traceFile = s_traceFile;
+    if (!traceFile->file.isOpen()) {
+        return;
+    }
+
+    QJsonObject event;
+    event[QStringLiteral("name")] = QLatin1String(phase);
+    event[QStringLiteral("cat")] = QStringLiteral("qml");
+    event[QStringLiteral("ph")] = QStringLiteral("X");
+    //microseconds, as doubles to keep the precision
+    event[QStringLiteral("ts")] = start / 1000.0;
+    event[QStringLiteral("dur")] = (end - start) / 1000.0;
+    event[QStringLiteral("pid")] = QCoreApplication::applicationPid();
+    event[QStringLiteral("tid")] = qint64(quintptr(QThread::currentThreadId()));
+    event[QStringLiteral("args")] = QJsonObject{{QStringLiteral("source"), source.toString()}};
+
+    QMutexLocker locker(&traceFile->mutex);
+    //no separator after the last event, so that closing the array gives valid JSON
+    if (!traceFile->empty) {
+        traceFile->file.write(",\n");
+    }
+    traceFile->empty = false;
+    traceFile->file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    traceFile->file.flush();
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef LOADTRACER_P_H
+#define LOADTRACER_P_H
+
+#include <QtGlobal>
+
+class QUrl;
+
+namespace KDeclarative {
+
+/**
+ * Writes the loading phases of QmlObjects as Chrome trace events
+ * (chrome://tracing, or any viewer of the trace event format) to the file
+ * named by the KDECLARATIVE_TRACE_FILE environment variable.
+ * Nothing is written if it's not set.
+ */
+class LoadTracer
+{
+public:
+    /**
+     * @returns a monotonic timestamp in nanoseconds, to be given to trace()
+     */
+    static qint64 now();
+
+    /**
+     * Records that @p phase of the loading of @p source happened from @p start to @p end
+     */
+    static void trace(const char *phase, const QUrl &source, qint64 start, qint64 end);
+};
+
+}
+
+#endif
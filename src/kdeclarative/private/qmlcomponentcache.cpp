@@ -0,0 +1,124 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "qmlcomponentcache_p.h"
+
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QQmlEngine>
+
+namespace KDeclarative {
+
+QmlComponentCache *QmlComponentCache::forEngine(QQmlEngine *engine)
+{
+    QmlComponentCache *cache = engine->findChild<QmlComponentCache *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!cache) {
+        cache = new QmlComponentCache(engine);
+    }
+    return cache;
+}
+
+QmlComponentCache::QmlComponentCache(QQmlEngine *engine)
+    : QObject(engine),
+      m_engine(engine),
+      m_watcher(new QFileSystemWatcher(this))
+{
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &QmlComponentCache::fileChanged);
+}
+
+QSharedPointer<QQmlComponent> QmlComponentCache::component(const QUrl &url, QQmlComponent::CompilationMode mode)
+{
+    QSharedPointer<QQmlComponent> component = m_components.value(url).toStrongRef();
+    if (component) {
+        return component;
+    }
+
+    //parented to us, so that components still referenced somewhere go away with the engine
+    QPointer<QQmlComponent> guard = new QQmlComponent(m_engine, this);
+    QPointer<QmlComponentCache> cache = this;
+    component = QSharedPointer<QQmlComponent>(guard.data(), [cache, url, guard](QQmlComponent *deleted) {
+        if (cache) {
+            cache->m_sharedComponents.remove(deleted);
+            //don't remove a newer component loaded after the file changed
+            if (cache->m_components.value(url).isNull()) {
+                cache->m_components.remove(url);
+                if (url.isLocalFile()) {
+                    cache->m_watcher->removePath(url.toLocalFile());
+                }
+            }
+        }
+        delete guard.data();
+    });
+    m_sharedComponents[component.data()] = component.toWeakRef();
+
+    component->loadUrl(url, mode);
+    if (component->isError()) {
+        return component;
+    }
+
+    if (component->isLoading()) {
+        QQmlComponent *loading = component.data();
+        connect(loading, &QQmlComponent::statusChanged, this, [this, url, loading](QQmlComponent::Status status) {
+            if (status == QQmlComponent::Error && m_components.value(url).toStrongRef().data() == loading) {
+                m_components.remove(url);
+            }
+        });
+    }
+
+    m_components[url] = component.toWeakRef();
+    if (url.isLocalFile()) {
+        //files replaced rather than modified in place drop out of the watcher, add them again
+        m_watcher->addPath(url.toLocalFile());
+    }
+
+    return component;
+}
+
+bool QmlComponentCache::contains(const QUrl &url) const
+{
+    return !m_components.value(url).isNull();
+}
+
+QSharedPointer<QQmlComponent> QmlComponentCache::sharedComponent(QQmlComponent *component)
+{
+    QmlComponentCache *cache = component ? qobject_cast<QmlComponentCache *>(component->parent()) : nullptr;
+    if (!cache) {
+        return QSharedPointer<QQmlComponent>();
+    }
+    return cache->m_sharedComponents.value(component).toStrongRef();
+}
+
+void QmlComponentCache::fileChanged(const QString &path)
+{
+    m_components.remove(QUrl::fromLocalFile(path));
+    //the engine keeps its own cache of compiled types, let go of the ones not in use anymore
+    m_engine->trimComponentCache();
+}
+
+
+
+QmlComponentRef::QmlComponentRef(const QSharedPointer<QQmlComponent> &component, QObject *parent)
+    : QObject(parent),
+      m_component(component)
+{
+}
+
+}
+
+#include "moc_qmlcomponentcache_p.cpp"
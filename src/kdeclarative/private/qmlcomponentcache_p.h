@@ -0,0 +1,94 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef QMLCOMPONENTCACHE_P_H
+#define QMLCOMPONENTCACHE_P_H
+
+#include <QHash>
+#include <QObject>
+#include <QQmlComponent>
+#include <QSharedPointer>
+#include <QUrl>
+
+class QFileSystemWatcher;
+class QQmlEngine;
+
+namespace KDeclarative {
+
+/**
+ * Components already loaded for a given engine, shared by all the QmlObjects using it.
+ *
+ * Components stay in the cache as long as somebody holds a reference to them,
+ * and local files are watched so that a modified file is loaded again the next
+ * time it's asked for.
+ */
+class QmlComponentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @returns the cache of @p engine, created on first use and deleted with the engine
+     */
+    static QmlComponentCache *forEngine(QQmlEngine *engine);
+
+    /**
+     * @returns the component for @p url, loading it with @p mode if it's not in the cache yet.
+     * A component being loaded asynchronously is shared as well.
+     * Components that failed to load are not cached.
+     */
+    QSharedPointer<QQmlComponent> component(const QUrl &url, QQmlComponent::CompilationMode mode = QQmlComponent::PreferSynchronous);
+
+    /**
+     * @returns whether a component for @p url is in the cache
+     */
+    bool contains(const QUrl &url) const;
+
+    /**
+     * @returns a reference to @p component if it was handed out by the cache of
+     *          its engine and is still in use, a null pointer otherwise
+     */
+    static QSharedPointer<QQmlComponent> sharedComponent(QQmlComponent *component);
+
+private:
+    explicit QmlComponentCache(QQmlEngine *engine);
+    void fileChanged(const QString &path);
+
+    QQmlEngine *m_engine;
+    QHash<QUrl, QWeakPointer<QQmlComponent> > m_components;
+    //all the components handed out, including the ones replaced after their file changed
+    QHash<QQmlComponent *, QWeakPointer<QQmlComponent> > m_sharedComponents;
+    QFileSystemWatcher *m_watcher;
+};
+
+/**
+ * Keeps a shared component alive as long as its parent, an object created from it.
+ */
+class QmlComponentRef : public QObject
+{
+public:
+    QmlComponentRef(const QSharedPointer<QQmlComponent> &component, QObject *parent);
+
+private:
+    QSharedPointer<QQmlComponent> m_component;
+};
+
+}
+
+#endif
@@ -19,14 +19,20 @@
 
 #include "qmlobject.h"
 #include "private/kdeclarative_p.h"
+#include "private/incubationcontroller_p.h"
+#include "private/loadtracer_p.h"
+#include "private/qmlcomponentcache_p.h"
 
 #include <QQmlComponent>
 #include <QQmlEngine>
 #include <QQmlContext>
 #include <QQuickItem>
 #include <QQmlIncubator>
+#include <QCache>
+#include <QMutex>
 #include <QTimer>
 #include <QPointer>
+#include <QMetaProperty>
 
 #include <qdebug.h>
 #include <kdeclarative.h>
@@ -37,30 +43,146 @@
 
 namespace KDeclarative {
 
-class QmlObjectIncubator : public QQmlIncubator
+/*
+ * Property indexes of each type by name, as QObject::setProperty() looks them up linearly every time.
+ * Used by the QmlObjects of all threads, and bounded as types come and go with the
+ * components being reloaded: the least recently used types are dropped.
+ */
+class PropertyIndexes
 {
 public:
-    QVariantHash m_initialProperties;
-protected:
-    void setInitialState(QObject *object) override
+    PropertyIndexes()
     {
-        QHashIterator<QString, QVariant> i(m_initialProperties);
-        while (i.hasNext()) {
-            i.next();
-            object->setProperty(i.key().toLatin1().data(), i.value());
+        //in types
+        m_types.setMaxCost(256);
+    }
+
+    //QML types have unique class names, so instances of a type share the indexes
+    //even if each of them has its own meta object
+    int index(const QMetaObject *metaObject, const QByteArray &name)
+    {
+        const QByteArray type(metaObject->className());
+
+        QMutexLocker locker(&m_mutex);
+        QHash<QByteArray, int> *indexes = m_types.object(type);
+        if (!indexes) {
+            indexes = new QHash<QByteArray, int>;
+            m_types.insert(type, indexes);
+        }
+
+        auto it = indexes->constFind(name);
+        if (it == indexes->constEnd()) {
+            it = indexes->insert(name, metaObject->indexOfProperty(name.constData()));
         }
+        return it.value();
+    }
+
+private:
+    QMutex m_mutex;
+    QCache<QByteArray, QHash<QByteArray, int> > m_types;
+};
+
+Q_GLOBAL_STATIC(PropertyIndexes, s_propertyIndexes)
+
+static int propertyIndex(const QMetaObject *metaObject, const QByteArray &name)
+{
+    return s_propertyIndexes->index(metaObject, name);
+}
+
+class QmlObjectPrivate;
+
+class QmlObjectIncubator : public QQmlIncubator
+{
+public:
+    void setInitialProperties(const QVariantHash &initialProperties);
+
+    //set for the incubator of the root object
+    QmlObjectPrivate *m_owner = nullptr;
+    //accumulated over all the objects created by this incubator
+    qint64 m_initialStateDuration = 0;
+protected:
+    void statusChanged(Status status) override;
+    void setInitialState(QObject *object) override;
+
+private:
+    //keys are converted and resolved once, and kept as long as
+    //the following objects are of the same type with the same keys
+    QVector<QString> m_keys;
+    QVector<QByteArray> m_names;
+    QVector<QVariant> m_values;
+    QByteArray m_resolvedType;
+    QVector<int> m_indexes;
+};
+
+void QmlObjectIncubator::setInitialProperties(const QVariantHash &initialProperties)
+{
+    QVector<QString> keys;
+    keys.reserve(initialProperties.count());
+    m_values.clear();
+    m_values.reserve(initialProperties.count());
+
+    bool sameKeys = initialProperties.count() == m_keys.count();
+    for (auto it = initialProperties.constBegin(); it != initialProperties.constEnd(); ++it) {
+        sameKeys = sameKeys && it.key() == m_keys.at(keys.count());
+        keys << it.key();
+        m_values << it.value();
     }
+
+    if (sameKeys) {
+        return;
+    }
+
+    m_keys = keys;
+    m_names.clear();
+    m_names.reserve(keys.count());
+    for (const QString &key : qAsConst(keys)) {
+        m_names << key.toLatin1();
+    }
+    m_resolvedType.clear();
+}
+
+/*
+ * Creates the objects of createObjectsFromComponentAsync() one after the other,
+ * with a single incubator so that the resolved properties are reused.
+ */
+class BatchIncubator : public QmlObjectIncubator
+{
+public:
+    BatchIncubator(QmlObjectPrivate *d, QQmlComponent *component, int count, QQmlContext *context, const QVector<QVariantHash> &initialProperties);
+
+    void next();
+
+protected:
+    void statusChanged(Status status) override;
+
+private:
+    void objectIncubated();
+
+    QmlObjectPrivate *d;
+    QPointer<QQmlComponent> m_component;
+    int m_count;
+    QPointer<QQmlContext> m_context;
+    const QVector<QVariantHash> m_initialProperties;
+    QList<QObject *> m_objects;
 };
 
+//a single hash is used for all the objects
+static QVariantHash initialPropertiesAt(const QVector<QVariantHash> &initialProperties, int index)
+{
+    return initialProperties.count() == 1 ? initialProperties.first() : initialProperties.value(index);
+}
+
 class QmlObjectPrivate
 {
 public:
     QmlObjectPrivate(QmlObject *parent)
         : q(parent),
           engine(nullptr),
-          component(nullptr),
-          delay(false)
+          delay(false),
+          incubating(false),
+          asynchronous(false)
     {
+        incubator.m_owner = this;
         executionEndTimer = new QTimer(q);
         executionEndTimer->setInterval(0);
         executionEndTimer->setSingleShot(true);
@@ -69,6 +191,7 @@ public:
 
     ~QmlObjectPrivate()
     {
+        qDeleteAll(batches);
         delete incubator.object();
     }
 
@@ -82,20 +205,67 @@ public:
     void preferredWidthChanged();
     void preferredHeightChanged();
     void checkInitializationCompleted();
+    QObject *createObject(QmlObjectIncubator &incubator, QQmlComponent *component, QQmlContext *context, const QVariantHash &initialProperties);
+    void reparent(QObject *object, const QVariantHash &initialProperties);
+    void loadingFinished();
+    void incubationFinished();
 
     QmlObject *q;
 
     QUrl source;
     QQmlEngine *engine;
     QmlObjectIncubator incubator;
-    QQmlComponent *component;
+    QList<BatchIncubator *> batches;
+    QSharedPointer<QQmlComponent> component;
     QTimer *executionEndTimer;
     KDeclarative kdeclarative;
     KPackage::Package package;
     QQmlContext *rootContext;
+    QmlObject::LoadStatistics statistics;
+    qint64 loadingStart = 0;
+    qint64 incubationStart = 0;
     bool delay : 1;
+    //whether finished() is still to be emitted for a delayed initialization
+    bool incubating : 1;
+    bool asynchronous : 1;
 };
 
+void QmlObjectIncubator::setInitialState(QObject *object)
+{
+    const qint64 start = LoadTracer::now();
+    const QMetaObject *metaObject = object->metaObject();
+    if (m_resolvedType != metaObject->className()) {
+        m_resolvedType = metaObject->className();
+        m_indexes.resize(m_names.count());
+        for (int i = 0; i < m_names.count(); ++i) {
+            m_indexes[i] = propertyIndex(metaObject, m_names.at(i));
+        }
+    }
+
+    for (int i = 0; i < m_values.count(); ++i) {
+        if (m_indexes.at(i) >= 0) {
+            metaObject->property(m_indexes.at(i)).write(object, m_values.at(i));
+        } else {
+            //not a declared property, set a dynamic one
+            object->setProperty(m_names.at(i).constData(), m_values.at(i));
+        }
+    }
+
+    const qint64 end = LoadTracer::now();
+    m_initialStateDuration += end - start;
+    if (m_owner) {
+        LoadTracer::trace("initialState", m_owner->source, start, end);
+    }
+}
+
+void QmlObjectIncubator::statusChanged(Status status)
+{
+    //the incubator may be running from inside the engine, leave it before telling anybody
+    if (m_owner && status != Loading) {
+        QMetaObject::invokeMethod(m_owner->q, "checkInitializationCompleted", Qt::QueuedConnection);
+    }
+}
+
 void QmlObjectPrivate::errorPrint(QQmlComponent *component)
 {
     QString errorStr = QStringLiteral("Error loading QML file.\n");
@@ -116,13 +286,37 @@ void QmlObjectPrivate::execute(const QUrl &source)
         return;
     }
 
-    delete component;
-    component = new QQmlComponent(engine, q);
-    QObject::connect(component, &QQmlComponent::statusChanged,
-                     q, &QmlObject::statusChanged, Qt::QueuedConnection);
+    if (component) {
+        QObject::disconnect(component.data(), nullptr, q, nullptr);
+    }
     delete incubator.object();
+    incubator.clear();
+    incubating = false;
+
+    statistics = QmlObject::LoadStatistics();
+    loadingStart = LoadTracer::now();
 
-    component->loadUrl(source);
+    //components are shared with the other users of the engine, so they may be ready already
+    QmlComponentCache *cache = QmlComponentCache::forEngine(engine);
+    if (!cache->contains(source)) {
+        ++statistics.componentsLoaded;
+    }
+    component = cache->component(source, asynchronous ? QQmlComponent::Asynchronous : QQmlComponent::PreferSynchronous);
+    QObject::connect(component.data(), &QQmlComponent::statusChanged,
+                     q, &QmlObject::statusChanged, Qt::QueuedConnection);
+    QObject::connect(component.data(), &QQmlComponent::progressChanged,
+                     q, &QmlObject::progressChanged);
+    if (component->isLoading()) {
+        QObject::connect(component.data(), &QQmlComponent::statusChanged, q, [this]() {
+            loadingFinished();
+        });
+    } else {
+        loadingFinished();
+        const QQmlComponent::Status status = component->status();
+        QTimer::singleShot(0, q, [this, status]() {
+            emit q->statusChanged(status);
+        });
+    }
 
     if (delay) {
         executionEndTimer->start(0);
@@ -131,12 +325,34 @@ void QmlObjectPrivate::execute(const QUrl &source)
     }
 }
 
+void QmlObjectPrivate::loadingFinished()
+{
+    if (statistics.loading >= 0 || component->isLoading()) {
+        return;
+    }
+
+    const qint64 end = LoadTracer::now();
+    statistics.loading = end - loadingStart;
+    LoadTracer::trace("loading", source, loadingStart, end);
+}
+
+void QmlObjectPrivate::incubationFinished()
+{
+    const qint64 end = LoadTracer::now();
+    statistics.incubation = end - incubationStart;
+    statistics.initialState = incubator.m_initialStateDuration;
+    if (incubator.object()) {
+        ++statistics.objectsCreated;
+    }
+    LoadTracer::trace("incubation", source, incubationStart, end);
+}
+
 void QmlObjectPrivate::scheduleExecutionEnd()
 {
     if (component->isReady() || component->isError()) {
         q->completeInitialization();
     } else {
-        QObject::connect(component, SIGNAL(statusChanged(QQmlComponent::Status)), q, SLOT(completeInitialization()));
+        QObject::connect(component.data(), SIGNAL(statusChanged(QQmlComponent::Status)), q, SLOT(completeInitialization()));
     }
 }
 
@@ -249,6 +465,26 @@ bool QmlObject::isInitializationDelayed() const
     return d->delay;
 }
 
+void QmlObject::setAsynchronousLoading(bool asynchronous)
+{
+    d->asynchronous = asynchronous;
+}
+
+bool QmlObject::isAsynchronousLoading() const
+{
+    return d->asynchronous;
+}
+
+qreal QmlObject::progress() const
+{
+    return d->component ? d->component->progress() : 0;
+}
+
+QmlObject::LoadStatistics QmlObject::loadStatistics() const
+{
+    return d->statistics;
+}
+
 QQmlEngine *QmlObject::engine()
 {
     return d->engine;
@@ -265,7 +501,7 @@ QObject *QmlObject::rootObject() const
 
 QQmlComponent *QmlObject::mainComponent() const
 {
-    return d->component;
+    return d->component.data();
 }
 
 QQmlContext *QmlObject::rootContext() const
@@ -288,13 +524,14 @@ QQmlComponent::Status QmlObject::status() const
 
 void QmlObjectPrivate::checkInitializationCompleted()
 {
-    if (!incubator.isReady() && incubator.status() != QQmlIncubator::Error) {
-        QTimer::singleShot(0, q, SLOT(checkInitializationCompleted()));
+    if (!incubating || incubator.isLoading()) {
         return;
     }
+    incubating = false;
+    incubationFinished();
 
     if (!incubator.object()) {
-        errorPrint(component);
+        errorPrint(component.data());
     }
 
     emit q->finished();
@@ -314,63 +551,194 @@ void QmlObject::completeInitialization(const QVariantHash &initialProperties)
 
 
     if (d->component->status() != QQmlComponent::Ready || d->component->isError()) {
-        d->errorPrint(d->component);
+        d->errorPrint(d->component.data());
         return;
     }
 
-    d->incubator.m_initialProperties = initialProperties;
-    d->component->create(d->incubator, d->rootContext);
+    const qint64 start = LoadTracer::now();
+    d->incubator.setInitialProperties(initialProperties);
+    d->incubator.m_initialStateDuration = 0;
+    d->incubationStart = start;
 
     if (d->delay) {
-        d->checkInitializationCompleted();
+        //incubated in the idle time of frames, finished() is emitted when the incubator is done
+        IncubationController::install(d->engine);
+        d->incubating = true;
+        d->component->create(d->incubator, d->rootContext);
     } else {
+        d->incubating = false;
+        d->component->create(d->incubator, d->rootContext);
         d->incubator.forceCompletion();
+        d->incubationFinished();
 
         if (!d->incubator.object()) {
-            d->errorPrint(d->component);
+            d->errorPrint(d->component.data());
         }
+    }
+
+    const qint64 end = LoadTracer::now();
+    d->statistics.completeInitialization = end - start;
+    LoadTracer::trace("completeInitialization", d->source, start, end);
+
+    if (!d->delay) {
         emit finished();
     }
 }
 
 QObject *QmlObject::createObjectFromSource(const QUrl &source, QQmlContext *context, const QVariantHash &initialProperties)
 {
-    QQmlComponent *component = new QQmlComponent(d->engine, this);
-    component->loadUrl(source);
+    QmlComponentCache *cache = QmlComponentCache::forEngine(d->engine);
+    if (!cache->contains(source)) {
+        ++d->statistics.componentsLoaded;
+    }
+    const QSharedPointer<QQmlComponent> component = cache->component(source);
 
-    return createObjectFromComponent(component, context, initialProperties);
+    QmlObjectIncubator incubator;
+    QObject *object = d->createObject(incubator, component.data(), context, initialProperties);
+    if (object) {
+        //memory management: the component is shared, keep it around as long as the object
+        new QmlComponentRef(component, object);
+    }
+    return object;
 }
 
 QObject *QmlObject::createObjectFromComponent(QQmlComponent *component, QQmlContext *context, const QVariantHash &initialProperties)
 {
     QmlObjectIncubator incubator;
-    incubator.m_initialProperties = initialProperties;
-    component->create(incubator, context ? context : d->rootContext);
+    QObject *object = d->createObject(incubator, component, context, initialProperties);
+    if (object) {
+        //memory management: components shared through the cache, such as mainComponent(),
+        //can't be owned by one object, keep them around as long as the object instead
+        const QSharedPointer<QQmlComponent> shared = QmlComponentCache::sharedComponent(component);
+        if (shared) {
+            new QmlComponentRef(shared, object);
+        } else {
+            component->setParent(object);
+        }
+    }
+    return object;
+}
+
+QList<QObject *> QmlObject::createObjectsFromComponent(QQmlComponent *component, int count, QQmlContext *context, const QVector<QVariantHash> &initialProperties)
+{
+    QList<QObject *> objects;
+    objects.reserve(count);
+
+    //one incubator for all, so properties are resolved only once
+    QmlObjectIncubator incubator;
+    for (int i = 0; i < count; ++i) {
+        QObject *object = d->createObject(incubator, component, context, initialPropertiesAt(initialProperties, i));
+        if (!object) {
+            break;
+        }
+        objects << object;
+        incubator.clear();
+    }
+
+    return objects;
+}
+
+void QmlObject::createObjectsFromComponentAsync(QQmlComponent *component, int count, QQmlContext *context, const QVector<QVariantHash> &initialProperties)
+{
+    IncubationController::install(d->engine);
+
+    BatchIncubator *batch = new BatchIncubator(d, component, count, context, initialProperties);
+    d->batches << batch;
+    batch->next();
+}
+
+QObject *QmlObjectPrivate::createObject(QmlObjectIncubator &incubator, QQmlComponent *component, QQmlContext *context, const QVariantHash &initialProperties)
+{
+    incubator.setInitialProperties(initialProperties);
+    component->create(incubator, context ? context : rootContext);
     incubator.forceCompletion();
-  
+
     QObject *object = incubator.object();
 
     if (!component->isError() && object) {
-        //memory management
-        component->setParent(object);
-        //reparent to root object if wasn't specified otherwise by initialProperties
-        if (!initialProperties.contains(QStringLiteral("parent"))) {
-            if (qobject_cast<QQuickItem *>(rootObject())) {
-                object->setProperty("parent", QVariant::fromValue(rootObject()));
-            } else {
-                object->setParent(rootObject());
-            }
-        }
-
+        reparent(object, initialProperties);
+        ++statistics.objectsCreated;
         return object;
 
     } else {
-        d->errorPrint(component);
+        errorPrint(component);
         delete object;
         return nullptr;
     }
 }
 
+void QmlObjectPrivate::reparent(QObject *object, const QVariantHash &initialProperties)
+{
+    //reparent to root object if wasn't specified otherwise by initialProperties
+    if (!initialProperties.contains(QStringLiteral("parent"))) {
+        if (qobject_cast<QQuickItem *>(q->rootObject())) {
+            object->setProperty("parent", QVariant::fromValue(q->rootObject()));
+        } else {
+            object->setParent(q->rootObject());
+        }
+    }
+}
+
+BatchIncubator::BatchIncubator(QmlObjectPrivate *d, QQmlComponent *component, int count, QQmlContext *context, const QVector<QVariantHash> &initialProperties)
+    : d(d),
+      m_component(component),
+      m_count(count),
+      m_context(context ? context : d->rootContext),
+      m_initialProperties(initialProperties)
+{
+    m_objects.reserve(count);
+}
+
+void BatchIncubator::next()
+{
+    if (m_component && !m_component->isReady()) {
+        d->errorPrint(m_component.data());
+        m_count = m_objects.count();
+    }
+
+    if (!m_component || !m_context || m_objects.count() >= m_count) {
+        emit d->q->objectsCreated(m_component.data(), m_objects);
+        d->batches.removeOne(this);
+        delete this;
+        return;
+    }
+
+    setInitialProperties(initialPropertiesAt(m_initialProperties, m_objects.count()));
+    m_component->create(*this, m_context);
+}
+
+void BatchIncubator::statusChanged(Status status)
+{
+    //don't clear the incubator from inside the engine
+    if (status != Loading && status != Null) {
+        QMetaObject::invokeMethod(d->q, [this]() {
+            objectIncubated();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void BatchIncubator::objectIncubated()
+{
+    QObject *object = this->object();
+
+    if (isReady() && object) {
+        d->reparent(object, initialPropertiesAt(m_initialProperties, m_objects.count()));
+        ++d->statistics.objectsCreated;
+        m_objects << object;
+        clear();
+        next();
+    } else {
+        //stop at the first error, like createObjectsFromComponent()
+        if (m_component) {
+            d->errorPrint(m_component.data());
+        }
+        delete object;
+        clear();
+        m_count = m_objects.count();
+        next();
+    }
+}
+
 }
 
 #include "moc_qmlobject.cpp"
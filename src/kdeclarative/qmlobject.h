@@ -27,6 +27,7 @@
 #include <QGuiApplication>
 #include <QScreen>
 #include <QQmlComponent>
+#include <QVector>
 
 #include <KPackage/Package>
 #include <kdeclarative/kdeclarative_export.h>
@@ -59,11 +60,33 @@ class KDECLARATIVE_EXPORT QmlObject : public QObject
     Q_PROPERTY(QUrl source READ source WRITE setSource)
     Q_PROPERTY(QString translationDomain READ translationDomain WRITE setTranslationDomain)
     Q_PROPERTY(bool initializationDelayed READ isInitializationDelayed WRITE setInitializationDelayed)
+    Q_PROPERTY(bool asynchronousLoading READ isAsynchronousLoading WRITE setAsynchronousLoading)
+    Q_PROPERTY(qreal progress READ progress NOTIFY progressChanged)
     Q_PROPERTY(QObject *rootObject READ rootObject)
     Q_PROPERTY(QQmlComponent::Status status READ status NOTIFY statusChanged)
 
 public:
 
+    /**
+     * Time spent in the phases of the loading of the QML file, in nanoseconds,
+     * -1 for the phases which didn't happen yet
+     * @since 5.57
+     */
+    struct LoadStatistics {
+        /// loading and compiling the QML file and its imports, or getting it from the cache
+        qint64 loading = -1;
+        /// creating the root object
+        qint64 incubation = -1;
+        /// setting the initial properties of the root object, part of the incubation
+        qint64 initialState = -1;
+        /// completeInitialization() itself, including the incubation unless it's delayed
+        qint64 completeInitialization = -1;
+        /// objects created, the root object and the ones from createObjectFromSource() and the like
+        int objectsCreated = 0;
+        /// components loaded for this object that weren't already in the cache of the engine
+        int componentsLoaded = 0;
+    };
+
     /**
      * Constructs a new QmlObject
      *
@@ -154,6 +177,9 @@ public:
      * In that case it will be possible to access it immediately from the QML code.
      * The initialization will either be completed automatically asynchronously
      * or explicitly by calling completeInitialization()
+     * The root object is then incubated in small steps in the idle time of the frames
+     * of the window being shown, or from a timer if there is none, and finished()
+     * is emitted once it's done.
      *
      * @param delay if true the initialization of the QML file will be delayed
      *              at the end of the event loop
@@ -166,6 +192,39 @@ public:
      */
     bool isInitializationDelayed() const;
 
+    /**
+     * Sets whether the QML file and its imports are loaded and compiled
+     * by the background type loader of the engine, rather than in the GUI thread.
+     * It has to be called before setSource().
+     * progressChanged() is emitted while loading, and finished() once the
+     * root object has been created.
+     *
+     * @param asynchronous if true the QML file is loaded asynchronously
+     * @since 5.57
+     */
+    void setAsynchronousLoading(bool asynchronous);
+
+    /**
+     * @return true if the QML file is loaded asynchronously
+     * @since 5.57
+     */
+    bool isAsynchronousLoading() const;
+
+    /**
+     * @return the loading progress of the QML file, from 0.0 to 1.0
+     * @since 5.57
+     */
+    qreal progress() const;
+
+    /**
+     * @return the time spent in the phases of the loading of the current source,
+     *         and what has been created and loaded for it.
+     *         Set the KDECLARATIVE_TRACE_FILE environment variable to a file name
+     *         to get them as Chrome trace events as well.
+     * @since 5.57
+     */
+    LoadStatistics loadStatistics() const;
+
     /**
      * @return the declarative engine that runs the qml file assigned to this widget.
      */
@@ -178,6 +237,8 @@ public:
 
     /**
      * @return the main QQmlComponent of the engine
+     * @note the component is shared with the other QmlObjects of the engine
+     *       loading the same source, and must not be deleted
      */
     QQmlComponent *mainComponent() const;
 
@@ -209,7 +270,10 @@ public:
     /**
      * Creates and returns an object based on the provided QQmlComponent
      * with the same QQmlEngine and the same root context as the admin object,
-     * that will be the parent of the newly created object
+     * that will be the parent of the newly created object.
+     * The component is reparented to the new object, except mainComponent()
+     * and the other components shared between QmlObjects, which are kept
+     * alive as long as the object instead.
      * @param component the component we want to instantiate
      * @param context The QQmlContext in which we will create the object,
      *             if 0 it will use the engine's root context
@@ -219,6 +283,30 @@ public:
      */
     QObject *createObjectFromComponent(QQmlComponent *component, QQmlContext *context = nullptr, const QVariantHash &initialProperties = QVariantHash());
 
+    /**
+     * Creates @p count objects based on the provided QQmlComponent in a single pass,
+     * with the same parenting rules as createObjectFromComponent().
+     * Initial properties are resolved once for all the objects.
+     * Unlike createObjectFromComponent(), the component is not reparented.
+     * @param component the component we want to instantiate
+     * @param count how many objects to create
+     * @param context The QQmlContext in which we will create the objects,
+     *             if 0 it will use the engine's root context
+     * @param initialProperties optional properties for each object,
+     *             a single hash is used for all of them
+     * @return the created objects, stopping at the first one that failed
+     * @since 5.57
+     */
+    QList<QObject *> createObjectsFromComponent(QQmlComponent *component, int count, QQmlContext *context = nullptr, const QVector<QVariantHash> &initialProperties = QVector<QVariantHash>());
+
+    /**
+     * Same as createObjectsFromComponent(), but the objects are incubated
+     * across frames in the idle time of the event loop.
+     * objectsCreated() is emitted when all of them have been created.
+     * @since 5.57
+     */
+    void createObjectsFromComponentAsync(QQmlComponent *component, int count, QQmlContext *context = nullptr, const QVector<QVariantHash> &initialProperties = QVector<QVariantHash>());
+
 public Q_SLOTS:
     /**
      * Finishes the process of initialization.
@@ -237,6 +325,20 @@ Q_SIGNALS:
 
     void statusChanged(QQmlComponent::Status);
 
+    /**
+     * Emitted while the QML file is being loaded
+     * @since 5.57
+     */
+    void progressChanged(qreal progress);
+
+    /**
+     * Emitted when the objects requested with createObjectsFromComponentAsync() are created
+     * @param component the component they have been created from
+     * @param objects the objects, stopping at the first one that failed
+     * @since 5.57
+     */
+    void objectsCreated(QQmlComponent *component, const QList<QObject *> &objects);
+
 protected:
     /**
      * Constructs a new QmlObject
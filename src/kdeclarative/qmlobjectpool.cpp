@@ -0,0 +1,328 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "qmlobjectpool.h"
+#include "private/incubationcontroller_p.h"
+#include "private/qmlcomponentcache_p.h"
+
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQmlIncubator>
+#include <QQuickItem>
+#include <QPointer>
+
+#include <qdebug.h>
+
+namespace KDeclarative {
+
+class QmlObjectPoolPrivate;
+
+class PoolIncubator : public QQmlIncubator
+{
+public:
+    PoolIncubator(QmlObjectPoolPrivate *d)
+        : QQmlIncubator(Asynchronous),
+          d(d)
+    {
+    }
+
+protected:
+    void statusChanged(Status status) override;
+
+private:
+    QmlObjectPoolPrivate *d;
+};
+
+class QmlObjectPoolPrivate
+{
+public:
+    QmlObjectPoolPrivate(QmlObjectPool *parent)
+        : q(parent),
+          engine(nullptr),
+          maximumSize(2),
+          incubator(this),
+          prefillContext(nullptr)
+    {
+    }
+
+    ~QmlObjectPoolPrivate()
+    {
+        //abort the incubation before the context goes away
+        incubator.clear();
+        delete prefillContext;
+    }
+
+    QSharedPointer<QQmlComponent> component(const QUrl &source, QQmlComponent::CompilationMode mode);
+    QQmlContext *createContext();
+    void adopt(QObject *object, const QUrl &source);
+    void keep(QObject *object, const QUrl &source);
+    void prefillNext();
+    void prefillIncubated();
+
+    QmlObjectPool *q;
+    QQmlEngine *engine;
+    QPointer<QQmlContext> rootContext;
+    int maximumSize;
+    //the components of the sources, kept alive as long as the pool
+    QHash<QUrl, QSharedPointer<QQmlComponent> > components;
+    //released objects, ready to be handed out again
+    QHash<QUrl, QList<QObject *> > idle;
+    //all the objects created by the pool still alive
+    QHash<QObject *, QUrl> sources;
+    //how many idle objects prefill() has been asked for
+    QHash<QUrl, int> prefillCounts;
+    PoolIncubator incubator;
+    QUrl prefillSource;
+    QQmlContext *prefillContext;
+};
+
+void PoolIncubator::statusChanged(Status status)
+{
+    //don't clear the incubator from inside the engine
+    if (status == Ready || status == Error) {
+        QMetaObject::invokeMethod(d->q, [this]() {
+            d->prefillIncubated();
+        }, Qt::QueuedConnection);
+    }
+}
+
+QSharedPointer<QQmlComponent> QmlObjectPoolPrivate::component(const QUrl &source, QQmlComponent::CompilationMode mode)
+{
+    QSharedPointer<QQmlComponent> &component = components[source];
+    if (!component) {
+        component = QmlComponentCache::forEngine(engine)->component(source, mode);
+        if (component->isLoading()) {
+            //prefilling goes on once it's ready
+            QObject::connect(component.data(), &QQmlComponent::statusChanged, q, [this]() {
+                QMetaObject::invokeMethod(q, [this]() {
+                    prefillNext();
+                }, Qt::QueuedConnection);
+            });
+        }
+    } else if (component->isLoading() && mode != QQmlComponent::Asynchronous) {
+        //still being loaded for prefill(), and it can't be waited for:
+        //a new component makes the engine complete the loading right away
+        component.reset(new QQmlComponent(engine, source, mode));
+    }
+
+    if (mode == QQmlComponent::Asynchronous && component->isLoading()) {
+        return component;
+    }
+
+    if (!component->isReady()) {
+        qWarning() << source.toString() << component->errors();
+        components.remove(source);
+        return QSharedPointer<QQmlComponent>();
+    }
+
+    return component;
+}
+
+QQmlContext *QmlObjectPoolPrivate::createContext()
+{
+    return new QQmlContext(rootContext ? rootContext.data() : engine->rootContext());
+}
+
+void QmlObjectPoolPrivate::adopt(QObject *object, const QUrl &source)
+{
+    sources.insert(object, source);
+    QObject::connect(object, &QObject::destroyed, q, [this, object]() {
+        auto it = idle.find(sources.take(object));
+        if (it != idle.end()) {
+            it->removeOne(object);
+        }
+    });
+}
+
+void QmlObjectPoolPrivate::keep(QObject *object, const QUrl &source)
+{
+    QList<QObject *> &objects = idle[source];
+    //released twice, it would be handed out twice as well
+    if (objects.contains(object)) {
+        return;
+    }
+
+    if (objects.count() >= maximumSize) {
+        object->deleteLater();
+        return;
+    }
+
+    if (QQuickItem *item = qobject_cast<QQuickItem *>(object)) {
+        item->setParentItem(nullptr);
+        item->setVisible(false);
+    }
+    object->setParent(q);
+
+    if (object->metaObject()->indexOfMethod("poolReset()") >= 0) {
+        QMetaObject::invokeMethod(object, "poolReset");
+    }
+
+    objects << object;
+}
+
+void QmlObjectPoolPrivate::prefillNext()
+{
+    if (!incubator.isNull()) {
+        return;
+    }
+
+    auto it = prefillCounts.begin();
+    while (it != prefillCounts.end()) {
+        if (idle.value(it.key()).count() >= qMin(it.value(), maximumSize)) {
+            ++it;
+            continue;
+        }
+
+        //compiled in the background as well, not at prefill() time
+        const QSharedPointer<QQmlComponent> component = this->component(it.key(), QQmlComponent::Asynchronous);
+        if (!component) {
+            it = prefillCounts.erase(it);
+            continue;
+        }
+        if (component->isLoading()) {
+            ++it;
+            continue;
+        }
+
+        prefillSource = it.key();
+        prefillContext = createContext();
+        component->create(incubator, prefillContext);
+        return;
+    }
+}
+
+void QmlObjectPoolPrivate::prefillIncubated()
+{
+    QObject *object = incubator.object();
+
+    if (incubator.isReady() && object) {
+        prefillContext->setParent(object);
+        adopt(object, prefillSource);
+        keep(object, prefillSource);
+    } else {
+        qWarning() << prefillSource.toString() << incubator.errors();
+        delete object;
+        delete prefillContext;
+        //don't try again and again
+        prefillCounts.remove(prefillSource);
+    }
+
+    prefillContext = nullptr;
+    incubator.clear();
+    prefillNext();
+}
+
+QmlObjectPool::QmlObjectPool(QQmlEngine *engine, QQmlContext *rootContext, QObject *parent)
+    : QObject(parent),
+      d(new QmlObjectPoolPrivate(this))
+{
+    d->engine = engine;
+    d->rootContext = rootContext;
+}
+
+QmlObjectPool::~QmlObjectPool()
+{
+    clear();
+    delete d;
+}
+
+void QmlObjectPool::setMaximumSize(int size)
+{
+    d->maximumSize = qMax(0, size);
+
+    for (auto it = d->idle.begin(); it != d->idle.end(); ++it) {
+        while (it->count() > d->maximumSize) {
+            it->takeLast()->deleteLater();
+        }
+    }
+}
+
+int QmlObjectPool::maximumSize() const
+{
+    return d->maximumSize;
+}
+
+void QmlObjectPool::prefill(const QUrl &source, int count)
+{
+    d->prefillCounts[source] = count;
+
+    IncubationController::install(d->engine);
+    d->prefillNext();
+}
+
+QObject *QmlObjectPool::acquire(const QUrl &source)
+{
+    QList<QObject *> &objects = d->idle[source];
+    if (!objects.isEmpty()) {
+        QObject *object = objects.takeLast();
+        object->setParent(nullptr);
+        if (QQuickItem *item = qobject_cast<QQuickItem *>(object)) {
+            item->setVisible(true);
+        }
+        //make up for the one taken
+        d->prefillNext();
+        return object;
+    }
+
+    const QSharedPointer<QQmlComponent> component = d->component(source, QQmlComponent::PreferSynchronous);
+    if (!component) {
+        return nullptr;
+    }
+
+    QQmlContext *context = d->createContext();
+    QObject *object = component->create(context);
+    if (!object) {
+        qWarning() << source.toString() << component->errors();
+        delete context;
+        return nullptr;
+    }
+
+    context->setParent(object);
+    d->adopt(object, source);
+    return object;
+}
+
+void QmlObjectPool::release(QObject *object)
+{
+    if (!object) {
+        return;
+    }
+
+    auto it = d->sources.constFind(object);
+    if (it == d->sources.constEnd()) {
+        qWarning() << "Object" << object << "doesn't come from this pool";
+        return;
+    }
+
+    d->keep(object, it.value());
+}
+
+void QmlObjectPool::clear()
+{
+    const QHash<QUrl, QList<QObject *> > idle = d->idle;
+    d->idle.clear();
+
+    for (const QList<QObject *> &objects : idle) {
+        qDeleteAll(objects);
+    }
+}
+
+}
+
+#include "moc_qmlobjectpool.cpp"
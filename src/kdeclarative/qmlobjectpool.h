@@ -0,0 +1,110 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef QMLOBJECTPOOL_H
+#define QMLOBJECTPOOL_H
+
+#include <QObject>
+#include <QUrl>
+
+#include <kdeclarative/kdeclarative_export.h>
+
+class QQmlContext;
+class QQmlEngine;
+
+namespace KDeclarative {
+
+class QmlObjectPoolPrivate;
+
+/**
+ * @class KDeclarative::QmlObjectPool qmlobjectpool.h KDeclarative/QmlObjectPool
+ *
+ * @short A pool of already created root objects, to be reused for QML files opened again and again
+ *
+ * Objects are asked for with acquire() and given back with release() instead of being deleted.
+ * Released objects are detached from their parent and hidden, and kept for the next acquire()
+ * of the same source, up to maximumSize() objects per source. If the root object
+ * has a poolReset() function, it is called when the object is released,
+ * to restore its initial state.
+ *
+ * prefill() creates objects ahead of time, in the idle time of the event loop.
+ *
+ * Each object gets its own context, a child of the root context of the pool.
+ * @since 5.57
+ */
+class KDECLARATIVE_EXPORT QmlObjectPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Constructs a new pool
+     *
+     * @param engine the engine objects are created with
+     * @param rootContext the parent context of the contexts of the objects,
+     *             if 0 it will use the engine's root context
+     * @param parent the parent of this object
+     */
+    explicit QmlObjectPool(QQmlEngine *engine, QQmlContext *rootContext = nullptr, QObject *parent = nullptr);
+    ~QmlObjectPool();
+
+    /**
+     * Sets how many released objects are kept for each source, 2 by default
+     */
+    void setMaximumSize(int size);
+
+    /**
+     * @return how many released objects are kept for each source
+     */
+    int maximumSize() const;
+
+    /**
+     * Creates objects for @p source in the idle time of the event loop,
+     * until @p count of them are available. @p source is compiled
+     * in the background as well if it wasn't loaded yet.
+     */
+    void prefill(const QUrl &source, int count);
+
+    /**
+     * @return an object for @p source, from the pool if there is one, or created now.
+     *         The caller is responsible for parenting it, and for giving it back with release().
+     *         nullptr is returned if the object can't be created.
+     */
+    QObject *acquire(const QUrl &source);
+
+    /**
+     * Gives back @p object, acquired from this pool, for later reuse.
+     * If there are already enough objects for its source, it's deleted.
+     * Releasing an object already in the pool does nothing.
+     */
+    void release(QObject *object);
+
+    /**
+     * Deletes all the objects in the pool
+     */
+    void clear();
+
+private:
+    friend class QmlObjectPoolPrivate;
+    QmlObjectPoolPrivate *const d;
+};
+
+}
+
+#endif // multiple inclusion guard
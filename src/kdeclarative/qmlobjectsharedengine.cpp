@@ -23,6 +23,8 @@
 #include <QQmlEngine>
 #include <QQmlContext>
 #include <QPointer>
+#include <QCoreApplication>
+#include <QTimer>
 
 #include <qdebug.h>
 #include <kdeclarative.h>
@@ -45,15 +47,76 @@ public:
         //when the refcount is 2, we are sure that the only refs are s_engine and our copy
         //of engineRef
         if (engineRef.use_count() == 2) {
+            //the timer would never fire once the application is quitting
+            if (s_keepAlive > 0 && QCoreApplication::instance() && !s_quitting && !QCoreApplication::closingDown()) {
+                //linger for a while, in case a new one comes
+                keepAliveTimer()->start(s_keepAlive);
+            } else {
+                s_engine.reset();
+            }
+        }
+    }
+
+    static QTimer *keepAliveTimer()
+    {
+        if (!s_keepAliveTimer) {
+            s_keepAliveTimer = new QTimer(QCoreApplication::instance());
+            s_keepAliveTimer->setSingleShot(true);
+            QObject::connect(s_keepAliveTimer.data(), &QTimer::timeout, &releaseEngine);
+        }
+        return s_keepAliveTimer;
+    }
+
+    static void watchQuit()
+    {
+        static bool watching = false;
+        if (watching || !QCoreApplication::instance()) {
+            return;
+        }
+        watching = true;
+        //don't outlive the application
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, []() {
+            s_quitting = true;
+            if (s_keepAliveTimer) {
+                s_keepAliveTimer->stop();
+            }
+            releaseEngine();
+        });
+    }
+
+    static void releaseEngine()
+    {
+        //only the static ref left
+        if (s_engine && s_engine.use_count() == 1) {
             s_engine.reset();
         }
     }
 
+    static void loadPrewarmImport(QQmlEngine *engine, int index)
+    {
+        if (index >= s_prewarmImports.count()) {
+            return;
+        }
+
+        //synchronous, plugins are loaded in this thread in any case
+        QQmlComponent component(engine);
+        component.setData("import QtQml 2.0\nimport " + s_prewarmImports.at(index).toUtf8() + "\nQtObject {}\n", QUrl());
+        if (component.isError()) {
+            qWarning() << "Could not load" << s_prewarmImports.at(index) << component.errors();
+        }
+
+        //one at a time, leaving the event loop some room in between
+        QTimer::singleShot(0, engine, [engine, index]() {
+            loadPrewarmImport(engine, index + 1);
+        });
+    }
+
     static QQmlEngine *engine()
     {
         if (!s_engine) {
             s_engine = std::make_shared<QQmlEngine>();
             KDeclarative::setupEngine(s_engine.get());
+            watchQuit();
         }
         return s_engine.get();
     }
@@ -62,9 +125,17 @@ public:
     std::shared_ptr<QQmlEngine> engineRef;
 
     static std::shared_ptr<QQmlEngine> s_engine;
+    static int s_keepAlive;
+    static bool s_quitting;
+    static QStringList s_prewarmImports;
+    static QPointer<QTimer> s_keepAliveTimer;
 };
 
 std::shared_ptr<QQmlEngine> QmlObjectSharedEnginePrivate::s_engine = std::shared_ptr<QQmlEngine>();
+int QmlObjectSharedEnginePrivate::s_keepAlive = 0;
+bool QmlObjectSharedEnginePrivate::s_quitting = false;
+QStringList QmlObjectSharedEnginePrivate::s_prewarmImports = QStringList();
+QPointer<QTimer> QmlObjectSharedEnginePrivate::s_keepAliveTimer = QPointer<QTimer>();
 
 QmlObjectSharedEngine::QmlObjectSharedEngine(QObject *parent)
     : QmlObject(QmlObjectSharedEnginePrivate::engine(), new QQmlContext(QmlObjectSharedEnginePrivate::engine()), this /*don't call setupEngine*/, parent),
@@ -77,6 +148,35 @@ QmlObjectSharedEngine::~QmlObjectSharedEngine()
     rootContext()->deleteLater();
 }
 
+void QmlObjectSharedEngine::setEngineKeepAlive(int msec)
+{
+    QmlObjectSharedEnginePrivate::s_keepAlive = qMax(0, msec);
+}
+
+int QmlObjectSharedEngine::engineKeepAlive()
+{
+    return QmlObjectSharedEnginePrivate::s_keepAlive;
+}
+
+void QmlObjectSharedEngine::setPrewarmImports(const QStringList &imports)
+{
+    QmlObjectSharedEnginePrivate::s_prewarmImports = imports;
+}
+
+QStringList QmlObjectSharedEngine::prewarmImports()
+{
+    return QmlObjectSharedEnginePrivate::s_prewarmImports;
+}
+
+void QmlObjectSharedEngine::prewarmEngine()
+{
+    //released on quit if it ends up not being used
+    QQmlEngine *engine = QmlObjectSharedEnginePrivate::engine();
+    QTimer::singleShot(0, engine, [engine]() {
+        QmlObjectSharedEnginePrivate::loadPrewarmImport(engine, 0);
+    });
+}
+
 
 }
 
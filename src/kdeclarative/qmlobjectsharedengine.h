@@ -39,6 +39,8 @@ class QmlObjectSharedEnginePrivate;
  * QQmlEngine instance exists for the whole application. Objects created by different
  * instances of QmlObjectSharedEngine will be insulated by having different creation 
  * contexts, accessible by QmlObject::rootContext()
+ * Components are shared by the instances as well, so a file loaded asynchronously
+ * (see QmlObject::setAsynchronousLoading()) by several of them is only loaded once.
  */
 class KDECLARATIVE_EXPORT QmlObjectSharedEngine : public QmlObject
 {
@@ -53,6 +55,50 @@ public:
     explicit QmlObjectSharedEngine(QObject *parent = nullptr);
     ~QmlObjectSharedEngine();
 
+    /**
+     * Sets for how long the shared engine, with its import and type caches,
+     * is kept once the last QmlObjectSharedEngine is deleted, so that the next
+     * one created in the meantime doesn't have to start from scratch.
+     * By default it's deleted right away.
+     *
+     * @param msec how long the engine is kept, in milliseconds
+     * @since 5.57
+     */
+    static void setEngineKeepAlive(int msec);
+
+    /**
+     * @return for how long the shared engine is kept once unused, in milliseconds
+     * @since 5.57
+     */
+    static int engineKeepAlive();
+
+    /**
+     * Sets the imports loaded by prewarmEngine()
+     *
+     * @param imports modules with their version, such as "org.kde.kirigami 2.4"
+     * @since 5.57
+     */
+    static void setPrewarmImports(const QStringList &imports);
+
+    /**
+     * @return the imports loaded by prewarmEngine()
+     * @since 5.57
+     */
+    static QStringList prewarmImports();
+
+    /**
+     * Creates the shared engine if it doesn't exist yet, and loads the
+     * prewarm imports one after the other in the idle time of the event loop,
+     * ahead of the first QmlObjectSharedEngine.
+     * Each import is loaded synchronously in the main thread, plugins included,
+     * blocking the event loop for as long as that import takes: list only the
+     * imports the first QmlObjectSharedEngine would load anyways.
+     * The engine is then kept until the first QmlObjectSharedEngine using it
+     * is deleted, as any other time.
+     * @since 5.57
+     */
+    static void prewarmEngine();
+
 private:
     friend class QmlObjectSharedEnginePrivate;
     const std::unique_ptr<QmlObjectSharedEnginePrivate> d;
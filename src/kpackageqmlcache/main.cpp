@@ -0,0 +1,95 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <QGuiApplication>
+
+#include <klocalizedstring.h>
+#include <qcommandlineparser.h>
+#include <qcommandlineoption.h>
+
+#include <kpackage/package.h>
+#include <kpackage/packageloader.h>
+#include <QQmlEngine>
+#include <kdeclarative/kdeclarative.h>
+
+#include "qmlpackagecache.h"
+
+#include <iostream>
+
+int main(int argc, char **argv)
+{
+    QCommandLineParser parser;
+    QGuiApplication app(argc, argv);
+
+    const QString description = i18n("Compiles the QML files of KPackages ahead of time");
+
+    app.setApplicationVersion(QStringLiteral("0.1"));
+    parser.addVersionOption();
+    parser.addHelpOption();
+    parser.setApplicationDescription(description);
+
+    QCommandLineOption typeOption(QStringList() << QStringLiteral("t") << QStringLiteral("type"), i18n("The type of the packages (default: KPackage/GenericQML)"), QStringLiteral("type"), QStringLiteral("KPackage/GenericQML"));
+    QCommandLineOption applicationOption(QStringList() << QStringLiteral("a") << QStringLiteral("application"), i18n("The name of the application loading the packages, as QML caches are per application (mandatory)"), QStringLiteral("application"));
+
+    parser.addOption(typeOption);
+    parser.addOption(applicationOption);
+    parser.addPositionalArgument(QStringLiteral("packages"), i18n("Names or paths of the packages to compile"), QStringLiteral("packages..."));
+
+    parser.process(app);
+
+    if (!parser.isSet(applicationOption) || parser.positionalArguments().isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    //caches are looked up in the cache location of the application using them
+    app.setApplicationName(parser.value(applicationOption));
+
+    QQmlEngine engine;
+    KDeclarative::KDeclarative::setupEngine(&engine);
+
+    int result = 0;
+    const QStringList packages = parser.positionalArguments();
+    for (const QString &packagePath : packages) {
+        KPackage::Package package = KPackage::PackageLoader::self()->loadPackage(parser.value(typeOption));
+        package.setPath(packagePath);
+        if (!package.isValid()) {
+            std::cerr << qPrintable(i18n("%1 is not a valid package", packagePath)) << std::endl;
+            result = 1;
+            continue;
+        }
+
+        const KDeclarative::QmlPackageCache cache(package);
+        if (cache.isValid()) {
+            std::cout << qPrintable(i18n("%1 is up to date", package.path())) << std::endl;
+            continue;
+        }
+
+        const QStringList errors = cache.compile(&engine);
+        if (!errors.isEmpty()) {
+            for (const QString &error : errors) {
+                std::cerr << qPrintable(error) << std::endl;
+            }
+            result = 1;
+            continue;
+        }
+        std::cout << qPrintable(i18n("Compiled %1", package.path())) << std::endl;
+    }
+
+    return result;
+}
@@ -0,0 +1,160 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "qmlpackagecache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <qdebug.h>
+
+namespace KDeclarative {
+
+static QString fileHash(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+//where QQmlEngine stores the compilation unit of a file in its disk cache
+static QString compilationUnitPath(const QString &fileName)
+{
+    const QString suffix = QFileInfo(fileName + QLatin1Char('c')).completeSuffix();
+    const QByteArray id = QCryptographicHash::hash(fileName.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/qmlcache/") + QString::fromLatin1(id) + QLatin1Char('.') + suffix;
+}
+
+QmlPackageCache::QmlPackageCache(const KPackage::Package &package)
+    : m_package(package)
+{
+}
+
+bool QmlPackageCache::isValid() const
+{
+    QFile file(manifestPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    if (QJsonDocument::fromJson(file.readAll()).object() != manifest()) {
+        return false;
+    }
+
+    //the disk cache of the engine may have been cleared since
+    const QStringList files = this->files();
+    for (const QString &fileName : files) {
+        if (!fileName.endsWith(QLatin1String(".qml"))) {
+            continue;
+        }
+        //shipped next to the file, or compiled by the engine
+        if (!QFile::exists(fileName + QLatin1Char('c')) && !QFile::exists(compilationUnitPath(fileName))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QStringList QmlPackageCache::compile(QQmlEngine *engine) const
+{
+    QStringList errors;
+
+    const QStringList files = this->files();
+    for (const QString &fileName : files) {
+        if (!fileName.endsWith(QLatin1String(".qml"))) {
+            //scripts are compiled with the files importing them
+            continue;
+        }
+
+        QQmlComponent component(engine);
+        component.loadUrl(QUrl::fromLocalFile(fileName), QQmlComponent::PreferSynchronous);
+        const auto componentErrors = component.errors();
+        for (const QQmlError &error : componentErrors) {
+            errors << error.toString();
+        }
+    }
+
+    writeManifest();
+    return errors;
+}
+
+QStringList QmlPackageCache::files() const
+{
+    QStringList files;
+
+    QDirIterator it(m_package.path(), {QStringLiteral("*.qml"), QStringLiteral("*.js")}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files << it.next();
+    }
+
+    files.sort();
+    return files;
+}
+
+QJsonObject QmlPackageCache::manifest() const
+{
+    const QDir root(m_package.path());
+
+    QJsonObject hashes;
+    const QStringList files = this->files();
+    for (const QString &fileName : files) {
+        hashes[root.relativeFilePath(fileName)] = fileHash(fileName);
+    }
+
+    return QJsonObject{
+        {QStringLiteral("qtVersion"), QString::fromLatin1(qVersion())},
+        {QStringLiteral("files"), hashes}
+    };
+}
+
+QString QmlPackageCache::manifestPath() const
+{
+    const QByteArray id = QCryptographicHash::hash(QFile::encodeName(m_package.path()), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/kpackage-qmlcache/") + QString::fromLatin1(id) + QStringLiteral(".json");
+}
+
+void QmlPackageCache::writeManifest() const
+{
+    const QString fileName = manifestPath();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not write the QML cache manifest" << fileName << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(manifest()).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef QMLPACKAGECACHE_H
+#define QMLPACKAGECACHE_H
+
+#include <QJsonObject>
+#include <QStringList>
+
+#include <KPackage/Package>
+
+class QQmlEngine;
+
+namespace KDeclarative {
+
+/**
+ * Ahead of time compilation of the QML files of a package.
+ *
+ * The files are compiled by an engine, which stores them in its disk cache,
+ * and a manifest with the hash of every file and the Qt version is written
+ * next to it, so that packages already compiled and unchanged since are skipped.
+ *
+ * Like the disk cache of the engine, manifests are per application.
+ */
+class QmlPackageCache
+{
+public:
+    explicit QmlPackageCache(const KPackage::Package &package);
+
+    /**
+     * @returns whether the package has been compiled with the running Qt version,
+     *          none of its files changed since and the engine still has all of them
+     *          in its disk cache
+     */
+    bool isValid() const;
+
+    /**
+     * Compiles all the QML files of the package with @p engine and writes the manifest
+     * @returns the errors of the files which failed to compile, one per line
+     */
+    QStringList compile(QQmlEngine *engine) const;
+
+private:
+    QStringList files() const;
+    QJsonObject manifest() const;
+    QString manifestPath() const;
+    void writeManifest() const;
+
+    KPackage::Package m_package;
+};
+
+}
+
+#endif
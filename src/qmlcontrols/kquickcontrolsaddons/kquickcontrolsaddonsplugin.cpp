@@ -69,6 +69,7 @@ void KQuickControlsAddonsPlugin::registerTypes(const char *uri)
 #endif
 
     qmlRegisterType<QAbstractItemModel>();
+    qmlRegisterType<KQuickAddons::FrameStream>();
     qRegisterMetaType<QModelIndex>("QModelIndex");
 }
 
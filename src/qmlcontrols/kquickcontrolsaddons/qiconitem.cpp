@@ -20,39 +20,259 @@
 
 #include "qiconitem.h"
 
+#include <QCache>
+#include <QGuiApplication>
+#include <QMutex>
+#include <QRunnable>
 #include <QSGSimpleTextureNode>
+#include <QThreadPool>
 #include <qquickwindow.h>
 #include <QIcon>
+#include <kiconloader.h>
 #include <quickaddons/imagetexturescache.h>
 #include <quickaddons/managedtexturenode.h>
 
 Q_GLOBAL_STATIC(ImageTexturesCache, s_iconImageCache)
 
+struct IconImageKey
+{
+    //icons created from a theme name are identified by theme and name, all the others by cacheKey:
+    //icons with the same name can still differ, e.g. KIconEngine ones with overlays
+    QString name;
+    qint64 cacheKey;
+    QSize size;
+    QIcon::Mode mode;
+    qreal devicePixelRatio;
+
+    bool operator==(const IconImageKey &other) const
+    {
+        return name == other.name && cacheKey == other.cacheKey && size == other.size
+            && mode == other.mode && qFuzzyCompare(devicePixelRatio, other.devicePixelRatio);
+    }
+};
+
+static uint qHash(const IconImageKey &key, uint seed = 0)
+{
+    return qHash(key.name, seed) ^ qHash(key.cacheKey) ^ qHash(key.size.width() << 16 | key.size.height())
+        ^ qHash(int(key.mode)) ^ qHash(int(key.devicePixelRatio * 100));
+}
+
+/*
+ * Rasterizations shared by all the QIconItem instances of the process:
+ * identical icons get the very same QImage, and therefore the same texture
+ * out of s_iconImageCache.
+ * Accessed from the render threads of all windows, hence the mutex.
+ */
+class IconImageCache
+{
+public:
+    IconImageCache()
+    {
+        //in KiB
+        m_images.setMaxCost(8 * 1024);
+    }
+
+    QImage image(const QIcon &icon, bool themeIcon, QWindow *window, const QSize &size, QIcon::Mode mode)
+    {
+        IconImageKey key;
+        if (themeIcon) {
+            key.name = QIcon::themeName() + QLatin1Char('/') + icon.name();
+            key.cacheKey = 0;
+        } else {
+            key.cacheKey = icon.cacheKey();
+        }
+        key.size = size;
+        key.mode = mode;
+        key.devicePixelRatio = window ? window->devicePixelRatio() : qApp->devicePixelRatio();
+
+        {
+            QMutexLocker locker(&m_mutex);
+            if (QImage *cached = m_images.object(key)) {
+                return *cached;
+            }
+        }
+
+        QImage img;
+        {
+            //pixmap() goes through the icon engine and KIconLoader, which aren't thread safe:
+            //serialized between the rasterization thread and the render threads
+            QMutexLocker locker(&m_rasterizationMutex);
+            img = icon.pixmap(window, size, mode, QIcon::On).toImage();
+        }
+
+        QMutexLocker locker(&m_mutex);
+        m_images.insert(key, new QImage(img), qMax<int>(1, img.sizeInBytes() / 1024));
+        return img;
+    }
+
+    void clear()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_images.clear();
+    }
+
+private:
+    QMutex m_mutex;
+    QMutex m_rasterizationMutex;
+    QCache<IconImageKey, QImage> m_images;
+};
+
+Q_GLOBAL_STATIC(IconImageCache, s_iconRasterizationCache)
+
+class IconRasterizationPool : public QThreadPool
+{
+public:
+    IconRasterizationPool()
+    {
+        //a single background thread, rasterizations are serialized anyways
+        setMaxThreadCount(1);
+    }
+};
+
+Q_GLOBAL_STATIC(IconRasterizationPool, s_iconRasterizationPool)
+
+/*
+ * Shared between a QIconItem and its rasterization jobs: jobs whose generation
+ * isn't the current one anymore are stale and get dropped, and the item pointer
+ * is reset under the mutex when the item goes away.
+ */
+class IconRasterizationState
+{
+public:
+    QMutex mutex;
+    QIconItem *item = nullptr;
+    QAtomicInt generation;
+};
+
+class IconRasterizationJob : public QRunnable
+{
+public:
+    IconRasterizationJob(const QSharedPointer<IconRasterizationState> &state, int generation,
+                         const QIcon &icon, bool themeIcon, const QSize &size, QIcon::Mode mode)
+        : m_state(state),
+          m_generation(generation),
+          m_icon(icon),
+          m_themeIcon(themeIcon),
+          m_size(size),
+          m_mode(mode)
+    {
+    }
+
+    void run() override
+    {
+        //the size changed again before we even started
+        if (m_state->generation.load() != m_generation) {
+            return;
+        }
+
+        //no window: the window is owned by the gui thread, rasterize at the application's device pixel ratio
+        const QImage image = s_iconRasterizationCache->image(m_icon, m_themeIcon, nullptr, m_size, m_mode);
+
+        QMutexLocker locker(&m_state->mutex);
+        if (m_state->item && m_state->generation.load() == m_generation) {
+            QMetaObject::invokeMethod(m_state->item, "rasterizationFinished", Qt::QueuedConnection,
+                                      Q_ARG(QImage, image), Q_ARG(int, m_generation));
+        }
+    }
+
+private:
+    QSharedPointer<IconRasterizationState> m_state;
+    const int m_generation;
+    const QIcon m_icon;
+    const bool m_themeIcon;
+    const QSize m_size;
+    const QIcon::Mode m_mode;
+};
+
+// the standard icon sizes first, then powers of two
+static int iconSizeBucket(int size)
+{
+    static const int buckets[] = {
+        KIconLoader::SizeSmall,
+        KIconLoader::SizeSmallMedium,
+        KIconLoader::SizeMedium,
+        KIconLoader::SizeLarge,
+        KIconLoader::SizeHuge,
+        KIconLoader::SizeEnormous,
+        256
+    };
+
+    if (size <= 0) {
+        return 0;
+    }
+
+    for (int bucket : buckets) {
+        if (size <= bucket) {
+            return bucket;
+        }
+    }
+
+    return qNextPowerOfTwo(quint32(size - 1));
+}
+
+static QIcon::Mode iconMode(QIconItem::State state)
+{
+    switch(state) {
+        case QIconItem::ActiveState:
+            return QIcon::Active;
+        case QIconItem::DisabledState:
+            return QIcon::Disabled;
+        case QIconItem::SelectedState:
+            return QIcon::Selected;
+        case QIconItem::DefaultState:
+        default:
+            return QIcon::Normal;
+    }
+}
+
 QIconItem::QIconItem(QQuickItem *parent)
     : QQuickItem(parent),
+      m_themeIcon(false),
       m_smooth(false),
       m_state(DefaultState),
-      m_changed(false)
+      m_changed(false),
+      m_asynchronous(false),
+      m_roundToIconSize(false)
 {
     setFlag(ItemHasContents, true);
+
+    //the icons of the theme or the effects of the states changed, what's cached is outdated
+    static bool watchingIconLoader = false;
+    if (!watchingIconLoader) {
+        watchingIconLoader = true;
+        connect(KIconLoader::global(), &KIconLoader::iconLoaderSettingsChanged, KIconLoader::global(), []() {
+            s_iconRasterizationCache->clear();
+        });
+        connect(KIconLoader::global(), &KIconLoader::iconChanged, KIconLoader::global(), []() {
+            s_iconRasterizationCache->clear();
+        });
+    }
+    //connected after the ones clearing the cache, so that the items rasterize again
+    connect(KIconLoader::global(), &KIconLoader::iconLoaderSettingsChanged, this, &QIconItem::markChanged);
+    connect(KIconLoader::global(), &KIconLoader::iconChanged, this, &QIconItem::markChanged);
 }
 
 
 QIconItem::~QIconItem()
 {
+    if (m_rasterizationState) {
+        QMutexLocker locker(&m_rasterizationState->mutex);
+        m_rasterizationState->item = nullptr;
+    }
 }
 
 void QIconItem::setIcon(const QVariant &icon)
 {
+    m_themeIcon = false;
     if(icon.canConvert<QIcon>()) {
         m_icon = icon.value<QIcon>();
     } else if(icon.canConvert<QString>()) {
         m_icon = QIcon::fromTheme(icon.toString());
+        m_themeIcon = !m_icon.name().isEmpty();
     } else {
         m_icon = QIcon();
     }
-    m_changed = true;
-    update();
+    markChanged();
     emit iconChanged();
 }
 
@@ -73,9 +293,8 @@ void QIconItem::setState(QIconItem::State state)
     }
 
     m_state = state;
-    m_changed = true;
+    markChanged();
     emit stateChanged(state);
-    update();
 }
 
 bool QIconItem::enabled() const
@@ -108,8 +327,7 @@ void QIconItem::setSmooth(const bool smooth)
         return;
     }
     m_smooth = smooth;
-    m_changed = true;
-    update();
+    markChanged();
     emit smoothChanged();
 }
 
@@ -118,6 +336,95 @@ bool QIconItem::smooth() const
     return m_smooth;
 }
 
+void QIconItem::setAsynchronous(bool asynchronous)
+{
+    if (asynchronous == m_asynchronous) {
+        return;
+    }
+    m_asynchronous = asynchronous;
+
+    if (m_asynchronous && !m_rasterizationState) {
+        m_rasterizationState.reset(new IconRasterizationState);
+        m_rasterizationState->item = this;
+    } else if (!m_asynchronous) {
+        //drop whatever is still running
+        m_rasterizationState->generation.ref();
+        m_asyncImage = QImage();
+    }
+
+    markChanged();
+    emit asynchronousChanged();
+}
+
+bool QIconItem::isAsynchronous() const
+{
+    return m_asynchronous;
+}
+
+void QIconItem::setRoundToIconSize(bool roundToIconSize)
+{
+    if (roundToIconSize == m_roundToIconSize) {
+        return;
+    }
+    m_roundToIconSize = roundToIconSize;
+    markChanged();
+    emit roundToIconSizeChanged();
+}
+
+bool QIconItem::roundToIconSize() const
+{
+    return m_roundToIconSize;
+}
+
+QSize QIconItem::rasterizationSize(const QSizeF &size) const
+{
+    if (m_roundToIconSize) {
+        //icons are square, pixmap() would give the square fitting in the item anyways
+        const int bucket = iconSizeBucket(qRound(qMin(size.width(), size.height())));
+        return QSize(bucket, bucket);
+    }
+    return QSize(size.width(), size.height());
+}
+
+void QIconItem::markChanged()
+{
+    m_changed = true;
+    if (m_asynchronous) {
+        polish();
+    }
+    update();
+}
+
+void QIconItem::updatePolish()
+{
+    QQuickItem::updatePolish();
+
+    if (!m_asynchronous) {
+        return;
+    }
+
+    //any job still queued or running is stale from now on
+    const int generation = m_rasterizationState->generation.fetchAndAddOrdered(1) + 1;
+
+    const QSize size = rasterizationSize(QSizeF(width(), height()));
+    if (m_icon.isNull() || size.isEmpty()) {
+        return;
+    }
+
+    s_iconRasterizationPool->start(new IconRasterizationJob(m_rasterizationState, generation, m_icon, m_themeIcon, size, iconMode(m_state)));
+}
+
+void QIconItem::rasterizationFinished(const QImage &image, int generation)
+{
+    if (!m_asynchronous || generation != m_rasterizationState->generation.load()) {
+        return;
+    }
+
+    m_asyncImage = image;
+    m_changed = true;
+    update();
+}
+
 QSGNode* QIconItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeData* /*data*/)
 {
     if (m_icon.isNull()) {
@@ -125,7 +432,15 @@ QSGNode* QIconItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeDa
         return nullptr;
     }
 
-    if (m_changed || node == nullptr) {
+    const QSize size(width(), height());
+    const QSize rasterSize = rasterizationSize(size);
+
+    if (m_asynchronous && m_asyncImage.isNull()) {
+        //nothing rasterized yet: keep the previous node, or none, until the job is done
+        if (!node) {
+            return nullptr;
+        }
+    } else if (m_changed || node == nullptr) {
         m_changed = false;
 
         ManagedTextureNode* mNode = dynamic_cast<ManagedTextureNode*>(node);
@@ -134,40 +449,34 @@ QSGNode* QIconItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeDa
             mNode = new ManagedTextureNode;
         }
 
-        QIcon::Mode mode;
-        switch(m_state) {
-            case DefaultState:
-                mode = QIcon::Normal;
-                break;
-            case ActiveState:
-                mode = QIcon::Active;
-                break;
-            case DisabledState:
-                mode = QIcon::Disabled;
-                break;
-            case SelectedState:
-                mode = QIcon::Selected;
-                break;
-        }
-
         QImage img;
-        const QSize size(width(), height());
-        if (!size.isEmpty()) {
-            img = m_icon.pixmap(size, mode, QIcon::On).toImage();
+        if (m_asynchronous) {
+            //until the job is done, keep showing what we have, scaled to the new size
+            img = m_asyncImage;
+        } else if (!rasterSize.isEmpty()) {
+            img = s_iconRasterizationCache->image(m_icon, m_themeIcon, window(), rasterSize, iconMode(m_state));
         }
-        mNode->setTexture(s_iconImageCache->loadTexture(window(), img));
-        mNode->setRect(QRect(QPoint(0,0), size));
+        mNode->setTexture(s_iconImageCache->loadTexture(window(), img, QQuickWindow::TextureCanUseAtlas));
         node = mNode;
     }
 
+    //resizing within the same rasterization size only changes the node geometry,
+    //the texture gets scaled so it has to be filtered
+    ManagedTextureNode *mNode = static_cast<ManagedTextureNode *>(node);
+    mNode->setRect(QRect(QPoint(0,0), size));
+    mNode->setFiltering(m_smooth || rasterSize != size ? QSGTexture::Linear : QSGTexture::Nearest);
+
     return node;
 }
 
 void QIconItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
 {
     if (newGeometry.size() != oldGeometry.size()) {
-        m_changed = true;
-        update();
+        if (rasterizationSize(newGeometry.size()) != rasterizationSize(oldGeometry.size())) {
+            markChanged();
+        } else {
+            update();
+        }
     }
     QQuickItem::geometryChanged(newGeometry, oldGeometry);
 }
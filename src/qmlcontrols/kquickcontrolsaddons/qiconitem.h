@@ -21,9 +21,13 @@
 #define QICONITEM_H
 
 #include <QIcon>
+#include <QImage>
 #include <QQuickItem>
+#include <QSharedPointer>
 #include <QVariant>
 
+class IconRasterizationState;
+
 class QIconItem : public QQuickItem
 {
     Q_OBJECT
@@ -34,6 +38,19 @@ class QIconItem : public QQuickItem
     Q_PROPERTY(int implicitHeight READ implicitHeight CONSTANT)
     Q_PROPERTY(State state READ state WRITE setState NOTIFY stateChanged)
     Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY stateChanged)
+    /**
+     * If true the icon is rasterized in a thread pool instead of during the
+     * scene graph synchronization; the previous icon (or nothing) is shown
+     * until the new one is ready. Default is false.
+     */
+    Q_PROPERTY(bool asynchronous READ isAsynchronous WRITE setAsynchronous NOTIFY asynchronousChanged)
+    /**
+     * If true the icon is rasterized at the next standard icon size (or power of two
+     * for big icons) above the smaller side of the item and scaled to the item size,
+     * so resizing within the same size doesn't rasterize it again. If false it's
+     * always rasterized at the exact item size. Default is false.
+     */
+    Q_PROPERTY(bool roundToIconSize READ roundToIconSize WRITE setRoundToIconSize NOTIFY roundToIconSizeChanged)
 
 public:
 
@@ -63,21 +80,42 @@ public:
     void setEnabled(bool enabled = true);
     bool enabled() const;
 
+    void setAsynchronous(bool asynchronous);
+    bool isAsynchronous() const;
+
+    void setRoundToIconSize(bool roundToIconSize);
+    bool roundToIconSize() const;
+
     QSGNode* updatePaintNode(QSGNode* node, UpdatePaintNodeData* data) override;
 
 Q_SIGNALS:
     void iconChanged();
     void smoothChanged();
     void stateChanged(State state);
+    void asynchronousChanged();
+    void roundToIconSizeChanged();
 
 protected:
     void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void updatePolish() override;
+
+private Q_SLOTS:
+    void rasterizationFinished(const QImage &image, int generation);
 
 private:
+    void markChanged();
+    QSize rasterizationSize(const QSizeF &size) const;
+
     QIcon m_icon;
+    //m_icon comes from QIcon::fromTheme(), without any other state
+    bool m_themeIcon;
     bool m_smooth;
     State m_state;
     bool m_changed;
+    bool m_asynchronous;
+    bool m_roundToIconSize;
+    QImage m_asyncImage;
+    QSharedPointer<IconRasterizationState> m_rasterizationState;
 };
 
 #endif
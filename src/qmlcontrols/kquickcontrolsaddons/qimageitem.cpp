@@ -19,14 +19,199 @@
  */
 
 #include "qimageitem.h"
+#include "texturerepeat.h"
 
+#include <QMutex>
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 #include <QPainter>
+#include <QQuickWindow>
+#include <QRunnable>
+#include <QSGTextureMaterial>
+#include <QThreadPool>
+#include <quickaddons/imagetexturescache.h>
+#include <quickaddons/managedtexturenode.h>
 
+Q_GLOBAL_STATIC(ImageTexturesCache, s_imageItemTexturesCache)
+
+/*
+ * Texture of a fixed size, updated in place with the frames of the stream.
+ */
+class StreamTexture : public QSGTexture
+{
+public:
+    StreamTexture(QQuickWindow *window, const QSize &size)
+        : m_textureId(0),
+          m_size(size),
+          m_context(QOpenGLContext::currentContext()),
+          m_window(window)
+    {
+        QOpenGLFunctions *f = m_context->functions();
+        f->glGenTextures(1, &m_textureId);
+        f->glBindTexture(GL_TEXTURE_2D, m_textureId);
+        f->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_size.width(), m_size.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        updateBindOptions(true);
+    }
+
+    ~StreamTexture() override
+    {
+        //a destroyed context took the texture with it
+        if (!m_context) {
+            return;
+        }
+        if (QOpenGLContext::currentContext() == m_context) {
+            m_context->functions()->glDeleteTextures(1, &m_textureId);
+        } else if (m_window) {
+            //nodes can outlive the render loop of their window, delete it where its context is current
+            m_window->scheduleRenderJob(new DeleteTextureJob(m_textureId), QQuickWindow::BeforeSynchronizingStage);
+        }
+    }
+
+    int textureId() const override
+    {
+        return m_textureId;
+    }
+
+    QSize textureSize() const override
+    {
+        return m_size;
+    }
+
+    bool hasAlphaChannel() const override
+    {
+        return true;
+    }
+
+    bool hasMipmaps() const override
+    {
+        return false;
+    }
+
+    void bind() override
+    {
+        QOpenGLContext::currentContext()->functions()->glBindTexture(GL_TEXTURE_2D, m_textureId);
+        updateBindOptions();
+    }
+
+    void upload(const QImage &frame)
+    {
+        QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+        f->glBindTexture(GL_TEXTURE_2D, m_textureId);
+        f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_size.width(), m_size.height(), GL_RGBA, GL_UNSIGNED_BYTE, frame.constBits());
+    }
+
+private:
+    class DeleteTextureJob : public QRunnable
+    {
+    public:
+        explicit DeleteTextureJob(GLuint textureId)
+            : m_textureId(textureId)
+        {
+        }
+
+        void run() override
+        {
+            if (QOpenGLContext::currentContext()) {
+                QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
+            }
+        }
+
+    private:
+        GLuint m_textureId;
+    };
+
+    GLuint m_textureId;
+    const QSize m_size;
+    QPointer<QOpenGLContext> m_context;
+    QPointer<QQuickWindow> m_window;
+};
+
+/*
+ * Shared between a QImageItem and its pyramid job: results of jobs started for a
+ * previous image are dropped, and the item pointer is reset when the item goes away.
+ */
+class MipmapState
+{
+public:
+    QMutex mutex;
+    QImageItem *item = nullptr;
+    int generation = 0;
+    QVector<QImage> levels;
+};
+
+// 2x2 box filter
+static QImage halfSize(const QImage &image)
+{
+    const int w = image.width();
+    const int h = image.height();
+    QImage half(qMax(1, w / 2), qMax(1, h / 2), QImage::Format_ARGB32_Premultiplied);
+
+    for (int y = 0; y < half.height(); ++y) {
+        const QRgb *line0 = reinterpret_cast<const QRgb *>(image.constScanLine(qMin(2 * y, h - 1)));
+        const QRgb *line1 = reinterpret_cast<const QRgb *>(image.constScanLine(qMin(2 * y + 1, h - 1)));
+        QRgb *dst = reinterpret_cast<QRgb *>(half.scanLine(y));
+        for (int x = 0; x < half.width(); ++x) {
+            const int x0 = qMin(2 * x, w - 1);
+            const int x1 = qMin(2 * x + 1, w - 1);
+            const QRgb p[] = {line0[x0], line0[x1], line1[x0], line1[x1]};
+            dst[x] = qRgba((qRed(p[0]) + qRed(p[1]) + qRed(p[2]) + qRed(p[3]) + 2) / 4,
+                           (qGreen(p[0]) + qGreen(p[1]) + qGreen(p[2]) + qGreen(p[3]) + 2) / 4,
+                           (qBlue(p[0]) + qBlue(p[1]) + qBlue(p[2]) + qBlue(p[3]) + 2) / 4,
+                           (qAlpha(p[0]) + qAlpha(p[1]) + qAlpha(p[2]) + qAlpha(p[3]) + 2) / 4);
+        }
+    }
+
+    return half;
+}
+
+class MipmapJob : public QRunnable
+{
+public:
+    MipmapJob(const QSharedPointer<MipmapState> &state, int generation, const QImage &image)
+        : m_state(state),
+          m_generation(generation),
+          m_image(image)
+    {
+    }
+
+    void run() override
+    {
+        {
+            QMutexLocker locker(&m_state->mutex);
+            if (!m_state->item || m_state->generation != m_generation) {
+                return;
+            }
+        }
+
+        QVector<QImage> levels;
+        QImage level = m_image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        while (level.width() > 1 || level.height() > 1) {
+            level = halfSize(level);
+            levels << level;
+        }
+
+        QMutexLocker locker(&m_state->mutex);
+        if (m_state->item && m_state->generation == m_generation) {
+            m_state->levels = levels;
+            QMetaObject::invokeMethod(m_state->item, "mipmapsReady", Qt::QueuedConnection);
+        }
+    }
+
+private:
+    QSharedPointer<MipmapState> m_state;
+    const int m_generation;
+    const QImage m_image;
+};
 
 QImageItem::QImageItem(QQuickItem *parent)
-    : QQuickPaintedItem(parent),
+    : QQuickItem(parent),
       m_smooth(false),
-      m_fillMode(QImageItem::Stretch)
+      m_fillMode(QImageItem::Stretch),
+      m_textureChanged(true),
+      m_cpuTiling(false),
+      m_mipmap(false),
+      m_currentMipLevel(0)
 {
     setFlag(ItemHasContents, true);
 }
@@ -34,12 +219,18 @@ QImageItem::QImageItem(QQuickItem *parent)
 
 QImageItem::~QImageItem()
 {
+    if (m_mipmapState) {
+        QMutexLocker locker(&m_mipmapState->mutex);
+        m_mipmapState->item = nullptr;
+    }
 }
 
 void QImageItem::setImage(const QImage &image)
 {
     bool oldImageNull = m_image.isNull();
     m_image = image;
+    m_textureChanged = true;
+    scheduleMipmaps();
     updatePaintedRect();
     update();
     emit nativeWidthChanged();
@@ -66,6 +257,9 @@ void QImageItem::setSmooth(const bool smooth)
         return;
     }
     m_smooth = smooth;
+    if (m_cpuTiling) {
+        m_textureChanged = true;
+    }
     update();
 }
 
@@ -95,36 +289,270 @@ void QImageItem::setFillMode(QImageItem::FillMode mode)
         return;
     }
 
+    //tiles are rendered in the texture
+    if (mode >= Tile || m_fillMode >= Tile) {
+        m_textureChanged = true;
+    }
     m_fillMode = mode;
     updatePaintedRect();
     update();
     emit fillModeChanged();
 }
 
-void QImageItem::paint(QPainter *painter)
+KQuickAddons::FrameStream *QImageItem::stream() const
+{
+    return m_stream;
+}
+
+void QImageItem::setStream(KQuickAddons::FrameStream *stream)
 {
-    if (m_image.isNull()) {
+    if (stream == m_stream) {
         return;
     }
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, m_smooth);
-    painter->setRenderHint(QPainter::SmoothPixmapTransform, m_smooth);
 
-     if (m_fillMode == TileVertically) {
-        painter->scale(width()/(qreal)m_image.width(), 1);
+    if (m_stream) {
+        disconnect(m_stream, nullptr, this, nullptr);
+    }
+    m_stream = stream;
+    if (m_stream) {
+        //published from the producer thread, the update picks up the latest frame
+        connect(m_stream, &KQuickAddons::FrameStream::framePublished, this, &QQuickItem::update, Qt::QueuedConnection);
+        connect(m_stream, &QObject::destroyed, this, [this]() {
+            m_textureChanged = true;
+            updatePaintedRect();
+            update();
+            emit streamChanged();
+        });
+    }
+
+    m_textureChanged = true;
+    updatePaintedRect();
+    update();
+    emit streamChanged();
+}
+
+bool QImageItem::mipmap() const
+{
+    return m_mipmap;
+}
+
+void QImageItem::setMipmap(bool mipmap)
+{
+    if (mipmap == m_mipmap) {
+        return;
+    }
+
+    m_mipmap = mipmap;
+    m_textureChanged = true;
+    scheduleMipmaps();
+    update();
+    emit mipmapChanged();
+}
+
+void QImageItem::scheduleMipmaps()
+{
+    m_mipLevels.clear();
+
+    if (!m_mipmap && !m_mipmapState) {
+        return;
+    }
+
+    if (!m_mipmapState) {
+        m_mipmapState.reset(new MipmapState);
+        m_mipmapState->item = this;
+    }
+
+    int generation;
+    {
+        QMutexLocker locker(&m_mipmapState->mutex);
+        //whatever is running is for the previous image
+        generation = ++m_mipmapState->generation;
+        m_mipmapState->levels.clear();
+    }
+
+    if (m_mipmap && !m_image.isNull()) {
+        QThreadPool::globalInstance()->start(new MipmapJob(m_mipmapState, generation, m_image));
+    }
+}
+
+void QImageItem::mipmapsReady()
+{
+    {
+        QMutexLocker locker(&m_mipmapState->mutex);
+        m_mipLevels = m_mipmapState->levels;
+        m_mipmapState->levels.clear();
+    }
+
+    update();
+}
+
+int QImageItem::mipLevel() const
+{
+    //the smallest level still at least as big as what's painted
+    const qreal devicePixelRatio = window() ? window()->effectiveDevicePixelRatio() : 1;
+    const QSizeF targetSize = QSizeF(m_paintedRect.size()) * devicePixelRatio;
+
+    int level = 0;
+    for (int i = 0; i < m_mipLevels.count(); ++i) {
+        const QSize size = m_mipLevels.at(i).size();
+        if (size.width() < targetSize.width() || size.height() < targetSize.height()) {
+            break;
+        }
+        level = i + 1;
+    }
+    return level;
+}
+
+QSize QImageItem::contentSize() const
+{
+    return m_stream ? m_stream->frameSize() : m_image.size();
+}
+
+QImage QImageItem::tiledImage() const
+{
+    //at the resolution of the window, tiles keep the logical size of the image
+    const qreal ratio = window() ? window()->effectiveDevicePixelRatio() : qApp->devicePixelRatio();
+    QImage tiled((boundingRect().size() * ratio).toSize(), QImage::Format_ARGB32_Premultiplied);
+    tiled.setDevicePixelRatio(ratio);
+    tiled.fill(Qt::transparent);
+
+    QPainter painter(&tiled);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, m_smooth);
+
+    if (m_fillMode == TileVertically) {
+        painter.scale(width()/(qreal)m_image.width(), 1);
     }
 
     if (m_fillMode == TileHorizontally) {
-        painter->scale(1, height()/(qreal)m_image.height());
+        painter.scale(1, height()/(qreal)m_image.height());
+    }
+
+    //scaled explicitly rather than relying on the brush for the device pixel ratio of the image
+    QImage tile = m_image;
+    tile.setDevicePixelRatio(1);
+    QBrush brush(tile);
+    brush.setTransform(QTransform::fromScale(1 / m_image.devicePixelRatio(), 1 / m_image.devicePixelRatio()));
+    painter.fillRect(m_paintedRect, brush);
+    return tiled;
+}
+
+QSGNode *QImageItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    if (contentSize().isEmpty() || m_paintedRect.isEmpty() || width() <= 0 || height() <= 0) {
+        delete oldNode;
+        return nullptr;
     }
 
-    if (m_fillMode >= Tile) {
-        painter->drawTiledPixmap(m_paintedRect, QPixmap::fromImage(m_image));
-    } else {
-        painter->drawImage(m_paintedRect, m_image, m_image.rect());
+    ManagedTextureNode *node = static_cast<ManagedTextureNode *>(oldNode);
+    if (!node) {
+        node = new ManagedTextureNode;
+        m_textureChanged = true;
     }
 
-    painter->restore();
+    FillMode fillMode = m_fillMode;
+
+    const int level = m_mipmap && !m_stream && m_fillMode < Tile ? mipLevel() : 0;
+    if (level != m_currentMipLevel) {
+        m_currentMipLevel = level;
+        m_textureChanged = true;
+    }
+
+    if (m_stream) {
+        const bool freshFrame = m_stream->takeFrame();
+
+        StreamTexture *texture = dynamic_cast<StreamTexture *>(node->texture());
+        if (m_textureChanged || !texture) {
+            m_textureChanged = false;
+            m_cpuTiling = false;
+            m_tiledImage = QImage();
+            //the software renderer has no streaming support
+            if (!QOpenGLContext::currentContext()) {
+                delete node;
+                return nullptr;
+            }
+            texture = new StreamTexture(window(), m_stream->frameSize());
+            //the last frame published, a paused stream may not publish any new one
+            texture->upload(m_stream->currentFrame());
+            node->setTexture(QSharedPointer<QSGTexture>(texture));
+        } else if (freshFrame) {
+            texture->upload(m_stream->currentFrame());
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
+
+        if (fillMode >= Tile && !canRepeatTexture(m_stream->frameSize())) {
+            fillMode = Stretch;
+        }
+    } else if (m_textureChanged) {
+        m_textureChanged = false;
+        m_cpuTiling = m_fillMode >= Tile && !canRepeatTexture(m_image.size());
+        if (m_cpuTiling) {
+            m_tiledImage = tiledImage();
+            node->setTexture(s_imageItemTexturesCache->loadTexture(window(), m_tiledImage));
+        } else if (m_fillMode >= Tile) {
+            //repeating needs a texture of its own, not a part of an atlas
+            m_tiledImage = QImage();
+            node->setTexture(s_imageItemTexturesCache->loadTexture(window(), m_image));
+        } else if (m_mipmap) {
+            m_tiledImage = QImage();
+            const QImage &image = level > 0 ? m_mipLevels.at(level - 1) : m_image;
+            node->setTexture(s_imageItemTexturesCache->loadTexture(window(), image));
+        } else {
+            m_tiledImage = QImage();
+            node->setTexture(s_imageItemTexturesCache->loadTexture(window(), m_image, QQuickWindow::TextureCanUseAtlas));
+        }
+    }
+
+    //tiles the stream can't repeat are stretched over the whole item
+    QRectF targetRect = fillMode != m_fillMode ? boundingRect() : QRectF(m_paintedRect);
+    QRectF sourceRect(QPointF(0, 0), node->texture()->textureSize());
+    QSGTexture::WrapMode horizontalWrapMode = QSGTexture::ClampToEdge;
+    QSGTexture::WrapMode verticalWrapMode = QSGTexture::ClampToEdge;
+
+    if (fillMode >= Tile) {
+        targetRect = boundingRect();
+        if (!m_cpuTiling) {
+            //texture coordinates past the texture size, one logical image pixel per item unit
+            //in the tiled directions, so a single quad shows all the tiles
+            const qreal ratio = m_stream ? 1 : m_image.devicePixelRatio();
+            if (fillMode != TileVertically) {
+                sourceRect.setWidth(width() * ratio);
+                horizontalWrapMode = QSGTexture::Repeat;
+            }
+            if (fillMode != TileHorizontally) {
+                sourceRect.setHeight(height() * ratio);
+                verticalWrapMode = QSGTexture::Repeat;
+            }
+        }
+    } else if (fillMode == PreserveAspectCrop) {
+        //only show the part of the image inside the item
+        const QRectF visibleRect = targetRect.intersected(boundingRect());
+        const qreal xScale = sourceRect.width() / targetRect.width();
+        const qreal yScale = sourceRect.height() / targetRect.height();
+        sourceRect = QRectF((visibleRect.x() - targetRect.x()) * xScale, (visibleRect.y() - targetRect.y()) * yScale,
+                            visibleRect.width() * xScale, visibleRect.height() * yScale);
+        targetRect = visibleRect;
+    }
+
+    node->setRect(targetRect);
+    node->setSourceRect(sourceRect);
+    //pyramid levels are scaled down by less than half
+    node->setFiltering(m_smooth || m_currentMipLevel > 0 ? QSGTexture::Linear : QSGTexture::Nearest);
+
+    QSGOpaqueTextureMaterial *materials[] = {
+        static_cast<QSGOpaqueTextureMaterial *>(node->material()),
+        static_cast<QSGOpaqueTextureMaterial *>(node->opaqueMaterial())
+    };
+    for (QSGOpaqueTextureMaterial *material : materials) {
+        if (material->horizontalWrapMode() != horizontalWrapMode || material->verticalWrapMode() != verticalWrapMode) {
+            material->setHorizontalWrapMode(horizontalWrapMode);
+            material->setVerticalWrapMode(verticalWrapMode);
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
+    }
+
+    return node;
 }
 
 bool QImageItem::isNull() const
@@ -134,7 +562,7 @@ bool QImageItem::isNull() const
 
 int QImageItem::paintedWidth() const
 {
-    if (m_image.isNull()) {
+    if (contentSize().isEmpty()) {
         return 0;
     }
 
@@ -143,7 +571,7 @@ int QImageItem::paintedWidth() const
 
 int QImageItem::paintedHeight() const
 {
-    if (m_image.isNull()) {
+    if (contentSize().isEmpty()) {
         return 0;
     }
 
@@ -152,8 +580,8 @@ int QImageItem::paintedHeight() const
 
 void QImageItem::updatePaintedRect()
 {
-
-    if (m_image.isNull()) {
+    const QSize size = contentSize();
+    if (size.isEmpty()) {
         return;
     }
 
@@ -163,7 +591,7 @@ void QImageItem::updatePaintedRect()
 
     switch (m_fillMode) {
     case PreserveAspectFit: {
-        QSize scaled = m_image.size();
+        QSize scaled = size;
 
         scaled.scale(boundingRect().size().toSize(), Qt::KeepAspectRatio);
         destRect = QRect(QPoint(0, 0), scaled);
@@ -171,7 +599,7 @@ void QImageItem::updatePaintedRect()
         break;
     }
     case PreserveAspectCrop: {
-        QSize scaled = m_image.size();
+        QSize scaled = size;
 
         scaled.scale(boundingRect().size().toSize(), Qt::KeepAspectRatioByExpanding);
         destRect = QRect(QPoint(0, 0), scaled);
@@ -180,12 +608,12 @@ void QImageItem::updatePaintedRect()
     }
     case TileVertically: {
         destRect = boundingRect().toRect();
-        destRect.setWidth(destRect.width() / (width()/(qreal)m_image.width()));
+        destRect.setWidth(destRect.width() / (width()/(qreal)size.width()));
         break;
     }
     case TileHorizontally: {
         destRect = boundingRect().toRect();
-        destRect.setHeight(destRect.height() / (height()/(qreal)m_image.height()));
+        destRect.setHeight(destRect.height() / (height()/(qreal)size.height()));
         break;
     }
     case Stretch:
@@ -203,6 +631,10 @@ void QImageItem::updatePaintedRect()
 
 void QImageItem::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
 {
-    QQuickPaintedItem::geometryChanged(newGeometry, oldGeometry);
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (m_cpuTiling && newGeometry.size() != oldGeometry.size()) {
+        m_textureChanged = true;
+    }
     updatePaintedRect();
+    update();
 }
@@ -21,10 +21,16 @@
 #ifndef QIMAGEITEM_H
 #define QIMAGEITEM_H
 
-#include <QQuickPaintedItem>
+#include <QQuickItem>
 #include <QImage>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QVector>
+#include <quickaddons/framestream.h>
 
-class QImageItem : public QQuickPaintedItem
+class MipmapState;
+
+class QImageItem : public QQuickItem
 {
     Q_OBJECT
 
@@ -36,6 +42,18 @@ class QImageItem : public QQuickPaintedItem
     Q_PROPERTY(int paintedHeight READ paintedHeight NOTIFY paintedHeightChanged)
     Q_PROPERTY(FillMode fillMode READ fillMode WRITE setFillMode NOTIFY fillModeChanged)
     Q_PROPERTY(bool null READ isNull NOTIFY nullChanged)
+    /**
+     * If true, a box filtered pyramid of the image is built in a thread pool when it's set,
+     * and the smallest level still covering the painted size is shown, with linear filtering.
+     * Useful for big images shown much smaller than their native size. Default is false.
+     */
+    Q_PROPERTY(bool mipmap READ mipmap WRITE setMipmap NOTIFY mipmapChanged)
+    /**
+     * Frames published by a C++ producer, shown instead of image while set.
+     * The frames are uploaded in place, the latest one at each synchronization.
+     * @see KQuickAddons::FrameStream
+     */
+    Q_PROPERTY(KQuickAddons::FrameStream *stream READ stream WRITE setStream NOTIFY streamChanged)
 
 public:
     enum FillMode {
@@ -67,10 +85,16 @@ public:
     FillMode fillMode() const;
     void setFillMode(FillMode mode);
 
-    void paint(QPainter *painter) override;
+    bool mipmap() const;
+    void setMipmap(bool mipmap);
+
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 
     bool isNull() const;
 
+    KQuickAddons::FrameStream *stream() const;
+    void setStream(KQuickAddons::FrameStream *stream);
+
 Q_SIGNALS:
     void nativeWidthChanged();
     void nativeHeightChanged();
@@ -79,18 +103,36 @@ Q_SIGNALS:
     void nullChanged();
     void paintedWidthChanged();
     void paintedHeightChanged();
+    void mipmapChanged();
+    void streamChanged();
 
 protected:
     void geometryChanged(const QRectF & newGeometry, const QRectF & oldGeometry) override;
 
 private:
+    QImage tiledImage() const;
+    QSize contentSize() const;
+    void scheduleMipmaps();
+    int mipLevel() const;
+
     QImage m_image;
+    QImage m_tiledImage;
     bool m_smooth;
     FillMode m_fillMode;
     QRect m_paintedRect;
+    bool m_textureChanged;
+    //set when the tiles have to be rendered in the texture
+    bool m_cpuTiling;
+    QPointer<KQuickAddons::FrameStream> m_stream;
+    bool m_mipmap;
+    //halved images, m_image being level 0
+    QVector<QImage> m_mipLevels;
+    int m_currentMipLevel;
+    QSharedPointer<MipmapState> m_mipmapState;
 
 private Q_SLOTS:
     void updatePaintedRect();
+    void mipmapsReady();
 
 };
 
@@ -19,14 +19,23 @@
  */
 
 #include "qpixmapitem.h"
+#include "texturerepeat.h"
 
+#include <QGuiApplication>
 #include <QPainter>
+#include <QQuickWindow>
+#include <QSGTextureMaterial>
+#include <quickaddons/imagetexturescache.h>
+#include <quickaddons/managedtexturenode.h>
 
+Q_GLOBAL_STATIC(ImageTexturesCache, s_pixmapItemTexturesCache)
 
 QPixmapItem::QPixmapItem(QQuickItem *parent)
-    : QQuickPaintedItem(parent),
+    : QQuickItem(parent),
       m_smooth(false),
-      m_fillMode(QPixmapItem::Stretch)
+      m_fillMode(QPixmapItem::Stretch),
+      m_textureChanged(true),
+      m_cpuTiling(false)
 {
     setFlag(ItemHasContents, true);
 
@@ -41,6 +50,8 @@ void QPixmapItem::setPixmap(const QPixmap &pixmap)
 {
     bool oldPixmapNull = m_pixmap.isNull();
     m_pixmap = pixmap;
+    m_image = m_pixmap.toImage();
+    m_textureChanged = true;
     updatePaintedRect();
     update();
     emit nativeWidthChanged();
@@ -67,6 +78,9 @@ void QPixmapItem::setSmooth(const bool smooth)
         return;
     }
     m_smooth = smooth;
+    if (m_cpuTiling) {
+        m_textureChanged = true;
+    }
     update();
 }
 
@@ -96,6 +110,10 @@ void QPixmapItem::setFillMode(QPixmapItem::FillMode mode)
         return;
     }
 
+    //tiles are rendered in the texture
+    if (mode >= Tile || m_fillMode >= Tile) {
+        m_textureChanged = true;
+    }
     m_fillMode = mode;
     updatePaintedRect();
     update();
@@ -103,30 +121,114 @@ void QPixmapItem::setFillMode(QPixmapItem::FillMode mode)
 
 }
 
-void QPixmapItem::paint(QPainter *painter)
+QImage QPixmapItem::tiledImage() const
 {
-    if (m_pixmap.isNull()) {
-        return;
-    }
-    painter->save();
-    painter->setRenderHint(QPainter::Antialiasing, m_smooth);
-    painter->setRenderHint(QPainter::SmoothPixmapTransform, m_smooth);
+    //at the resolution of the window, tiles keep the logical size of the image
+    const qreal ratio = window() ? window()->effectiveDevicePixelRatio() : qApp->devicePixelRatio();
+    QImage tiled((boundingRect().size() * ratio).toSize(), QImage::Format_ARGB32_Premultiplied);
+    tiled.setDevicePixelRatio(ratio);
+    tiled.fill(Qt::transparent);
+
+    QPainter painter(&tiled);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, m_smooth);
 
     if (m_fillMode == TileVertically) {
-        painter->scale(width()/(qreal)m_pixmap.width(), 1);
+        painter.scale(width()/(qreal)m_image.width(), 1);
     }
 
     if (m_fillMode == TileHorizontally) {
-        painter->scale(1, height()/(qreal)m_pixmap.height());
+        painter.scale(1, height()/(qreal)m_image.height());
     }
 
+    //scaled explicitly rather than relying on the brush for the device pixel ratio of the image
+    QImage tile = m_image;
+    tile.setDevicePixelRatio(1);
+    QBrush brush(tile);
+    brush.setTransform(QTransform::fromScale(1 / m_image.devicePixelRatio(), 1 / m_image.devicePixelRatio()));
+    painter.fillRect(m_paintedRect, brush);
+    return tiled;
+}
+
+QSGNode *QPixmapItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    if (m_image.isNull() || m_paintedRect.isEmpty() || width() <= 0 || height() <= 0) {
+        delete oldNode;
+        return nullptr;
+    }
+
+    ManagedTextureNode *node = static_cast<ManagedTextureNode *>(oldNode);
+    if (!node) {
+        node = new ManagedTextureNode;
+        m_textureChanged = true;
+    }
+
+    //geometry and fill mode changes don't need a new texture, except for tiles
+    //when the GPU can't repeat the image
+    if (m_textureChanged) {
+        m_textureChanged = false;
+        m_cpuTiling = m_fillMode >= Tile && !canRepeatTexture(m_image.size());
+        if (m_cpuTiling) {
+            m_tiledImage = tiledImage();
+            node->setTexture(s_pixmapItemTexturesCache->loadTexture(window(), m_tiledImage));
+        } else if (m_fillMode >= Tile) {
+            //repeating needs a texture of its own, not a part of an atlas
+            m_tiledImage = QImage();
+            node->setTexture(s_pixmapItemTexturesCache->loadTexture(window(), m_image));
+        } else {
+            m_tiledImage = QImage();
+            node->setTexture(s_pixmapItemTexturesCache->loadTexture(window(), m_image, QQuickWindow::TextureCanUseAtlas));
+        }
+    }
+
+    QRectF targetRect = m_paintedRect;
+    QRectF sourceRect(QPointF(0, 0), node->texture()->textureSize());
+    QSGTexture::WrapMode horizontalWrapMode = QSGTexture::ClampToEdge;
+    QSGTexture::WrapMode verticalWrapMode = QSGTexture::ClampToEdge;
+
     if (m_fillMode >= Tile) {
-        painter->drawTiledPixmap(m_paintedRect, m_pixmap);
-    } else {
-        painter->drawPixmap(m_paintedRect, m_pixmap, m_pixmap.rect());
+        targetRect = boundingRect();
+        if (!m_cpuTiling) {
+            //texture coordinates past the texture size, one logical image pixel per item unit
+            //in the tiled directions, so a single quad shows all the tiles
+            const qreal ratio = m_image.devicePixelRatio();
+            if (m_fillMode != TileVertically) {
+                sourceRect.setWidth(width() * ratio);
+                horizontalWrapMode = QSGTexture::Repeat;
+            }
+            if (m_fillMode != TileHorizontally) {
+                sourceRect.setHeight(height() * ratio);
+                verticalWrapMode = QSGTexture::Repeat;
+            }
+        }
+    } else if (m_fillMode == PreserveAspectCrop) {
+        //only show the part of the image inside the item
+        const QRectF visibleRect = targetRect.intersected(boundingRect());
+        const qreal xScale = sourceRect.width() / targetRect.width();
+        const qreal yScale = sourceRect.height() / targetRect.height();
+        sourceRect = QRectF((visibleRect.x() - targetRect.x()) * xScale, (visibleRect.y() - targetRect.y()) * yScale,
+                            visibleRect.width() * xScale, visibleRect.height() * yScale);
+        targetRect = visibleRect;
+    }
+
+    node->setRect(targetRect);
+    node->setSourceRect(sourceRect);
+    node->setFiltering(m_smooth ? QSGTexture::Linear : QSGTexture::Nearest);
+
+    QSGOpaqueTextureMaterial *materials[] = {
+        static_cast<QSGOpaqueTextureMaterial *>(node->material()),
+        static_cast<QSGOpaqueTextureMaterial *>(node->opaqueMaterial())
+    };
+    for (QSGOpaqueTextureMaterial *material : materials) {
+        if (material->horizontalWrapMode() != horizontalWrapMode || material->verticalWrapMode() != verticalWrapMode) {
+            material->setHorizontalWrapMode(horizontalWrapMode);
+            material->setVerticalWrapMode(verticalWrapMode);
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
     }
 
-    painter->restore();
+    return node;
 }
 
 bool QPixmapItem::isNull() const
@@ -206,7 +308,11 @@ void QPixmapItem::updatePaintedRect()
 
 void QPixmapItem::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
 {
-    QQuickPaintedItem::geometryChanged(newGeometry, oldGeometry);
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (m_cpuTiling && newGeometry.size() != oldGeometry.size()) {
+        m_textureChanged = true;
+    }
     updatePaintedRect();
+    update();
 }
 
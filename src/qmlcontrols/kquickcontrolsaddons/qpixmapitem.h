@@ -21,10 +21,11 @@
 #ifndef QPIXMAPITEM_H
 #define QPIXMAPITEM_H
 
-#include <QQuickPaintedItem>
+#include <QQuickItem>
+#include <QImage>
 #include <QPixmap>
 
-class QPixmapItem : public QQuickPaintedItem
+class QPixmapItem : public QQuickItem
 {
     Q_OBJECT
 
@@ -67,7 +68,7 @@ public:
     FillMode fillMode() const;
     void setFillMode(FillMode mode);
 
-    void paint(QPainter *painter) override;
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 
     bool isNull() const;
 
@@ -84,10 +85,18 @@ protected:
     void geometryChanged(const QRectF & newGeometry, const QRectF & oldGeometry) override;
 
 private:
+    QImage tiledImage() const;
+
     QPixmap m_pixmap;
+    //what gets uploaded, converted once when the pixmap is set
+    QImage m_image;
+    QImage m_tiledImage;
     bool m_smooth;
     FillMode m_fillMode;
     QRect m_paintedRect;
+    bool m_textureChanged;
+    //set when the tiles have to be rendered in the texture
+    bool m_cpuTiling;
 
 private Q_SLOTS:
     void updatePaintedRect();
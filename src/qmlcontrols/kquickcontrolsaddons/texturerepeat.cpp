@@ -0,0 +1,36 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "texturerepeat.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QSize>
+
+bool canRepeatTexture(const QSize &size)
+{
+    //the software renderer ignores wrap modes
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (!context) {
+        return false;
+    }
+
+    const bool powerOfTwo = !(size.width() & (size.width() - 1)) && !(size.height() & (size.height() - 1));
+    return powerOfTwo || context->functions()->hasOpenGLFeature(QOpenGLFunctions::NPOTTextureRepeat);
+}
@@ -0,0 +1,153 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "framestream.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+
+namespace KQuickAddons {
+
+/*
+ * Triple buffer: the producer owns the write frame, the consumer the read frame,
+ * and they swap them with the ready one.
+ * The ready index and whether it holds a frame not taken yet share one atomic.
+ * Shared with the frames being written, so that they outlive the stream.
+ */
+class FrameStreamPrivate
+{
+public:
+    enum {
+        IndexMask = 0x3,
+        FreshFrame = 0x4
+    };
+
+    explicit FrameStreamPrivate(const QSize &size)
+        : state(1),
+          writeIndex(0),
+          readIndex(2),
+          q(nullptr)
+    {
+        for (QImage &frame : frames) {
+            frame = QImage(size, QImage::Format_RGBA8888_Premultiplied);
+            frame.fill(Qt::transparent);
+        }
+    }
+
+    void publish();
+
+    QImage frames[3];
+    QAtomicInt state;
+    int writeIndex;
+    int readIndex;
+    QAtomicInt publishPending;
+    //reset by the stream when it goes away, while a producer may still be publishing
+    QMutex mutex;
+    FrameStream *q;
+};
+
+void FrameStreamPrivate::publish()
+{
+    //whatever was ready and not taken yet becomes the next frame to write in
+    const int previous = state.fetchAndStoreOrdered(writeIndex | FreshFrame);
+    writeIndex = previous & IndexMask;
+
+    //one notification in flight is enough, the consumer takes the latest frame
+    if (!publishPending.fetchAndStoreOrdered(1)) {
+        QMutexLocker locker(&mutex);
+        if (q) {
+            emit q->framePublished();
+        }
+    }
+}
+
+FrameStream::Frame::Frame(const QSharedPointer<FrameStreamPrivate> &d)
+    : d(d)
+{
+}
+
+FrameStream::Frame::Frame(Frame &&other)
+    : d(other.d)
+{
+    other.d.reset();
+}
+
+FrameStream::Frame::~Frame()
+{
+    publish();
+}
+
+QImage &FrameStream::Frame::image()
+{
+    Q_ASSERT(d);
+    return d->frames[d->writeIndex];
+}
+
+void FrameStream::Frame::publish()
+{
+    if (d) {
+        d->publish();
+        d.reset();
+    }
+}
+
+FrameStream::FrameStream(const QSize &frameSize, QObject *parent)
+    : QObject(parent),
+      d(new FrameStreamPrivate(frameSize))
+{
+    d->q = this;
+}
+
+FrameStream::~FrameStream()
+{
+    QMutexLocker locker(&d->mutex);
+    d->q = nullptr;
+}
+
+QSize FrameStream::frameSize() const
+{
+    return d->frames[0].size();
+}
+
+FrameStream::Frame FrameStream::beginFrame()
+{
+    return Frame(d);
+}
+
+bool FrameStream::takeFrame()
+{
+    d->publishPending.store(0);
+
+    if (!(d->state.load() & FrameStreamPrivate::FreshFrame)) {
+        return false;
+    }
+
+    const int previous = d->state.fetchAndStoreOrdered(d->readIndex);
+    d->readIndex = previous & FrameStreamPrivate::IndexMask;
+    return true;
+}
+
+const QImage &FrameStream::currentFrame() const
+{
+    return d->frames[d->readIndex];
+}
+
+}
+
+#include "moc_framestream.cpp"
@@ -0,0 +1,127 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FRAMESTREAM_H
+#define FRAMESTREAM_H
+
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+
+#include "quickaddons_export.h"
+
+namespace KQuickAddons {
+
+class FrameStreamPrivate;
+
+/**
+ * @class KQuickAddons::FrameStream framestream.h KQuickAddons/FrameStream
+ *
+ * @short Frames pushed at a high rate by a C++ producer, to be shown by an image item
+ *
+ * Three frames of frameSize(), in QImage::Format_RGBA8888_Premultiplied, are allocated
+ * once and reused: the producer writes in one, the consumer shows another one, and
+ * the third one holds the latest complete frame not shown yet, which is replaced
+ * if the producer is faster than the consumer.
+ *
+ * The stream itself belongs to the GUI thread, frames can be written from any thread.
+ * To show it, assign it to the stream property of QImageItem,
+ * from org.kde.kquickcontrolsaddons.
+ *
+ * @code
+ * KQuickAddons::FrameStream::Frame frame = stream->beginFrame();
+ * render(&frame.image());
+ * frame.publish();
+ * @endcode
+ *
+ * @since 5.57
+ */
+class QUICKADDONS_EXPORT FrameStream : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QSize frameSize READ frameSize CONSTANT)
+
+public:
+    /**
+     * A frame being written by the producer, published at the latest when it's destroyed.
+     * It stays valid even if the stream is deleted meanwhile.
+     */
+    class QUICKADDONS_EXPORT Frame
+    {
+    public:
+        Frame(Frame &&other);
+        ~Frame();
+
+        /**
+         * @returns the image to write in. Write through the reference and don't keep copies
+         *          of it: the image would be detached, and the copy written in instead.
+         *          Its content is the one of an older frame.
+         */
+        QImage &image();
+
+        /**
+         * Publishes the frame, it can't be written anymore afterwards
+         */
+        void publish();
+
+    private:
+        friend class FrameStream;
+        explicit Frame(const QSharedPointer<FrameStreamPrivate> &d);
+        Q_DISABLE_COPY(Frame)
+
+        QSharedPointer<FrameStreamPrivate> d;
+    };
+
+    explicit FrameStream(const QSize &frameSize, QObject *parent = nullptr);
+    ~FrameStream() override;
+
+    QSize frameSize() const;
+
+    /**
+     * @returns the frame to write the next image in.
+     * Only one frame can be written at a time.
+     */
+    Frame beginFrame();
+
+    /**
+     * For the consumer: makes the latest published frame the current one.
+     * @returns whether there was a frame published since the last call
+     */
+    bool takeFrame();
+
+    /**
+     * For the consumer: the current frame, owned by the consumer until the next takeFrame()
+     */
+    const QImage &currentFrame() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted from the thread of the producer when a frame has been published.
+     * It's not emitted again until the consumer called takeFrame().
+     */
+    void framePublished();
+
+private:
+    QSharedPointer<FrameStreamPrivate> d;
+};
+
+}
+
+#endif
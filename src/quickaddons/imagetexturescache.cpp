@@ -18,6 +18,11 @@
  */
 
 #include "imagetexturescache.h"
+#include "private/textureatlas_p.h"
+
+#include <QMutex>
+#include <QOpenGLContext>
+#include <QSGRendererInterface>
 #include <QSGTexture>
 #include <QDebug>
 
@@ -26,9 +31,43 @@ typedef QHash<qint64, QHash<QWindow*, QWeakPointer<QSGTexture> > > TexturesCache
 class ImageTexturesCachePrivate
 {
 public:
+    QSGTexture *createTexture(QQuickWindow *window, const QImage &image, QQuickWindow::CreateTextureOptions options);
+
+    TextureAtlas *atlas(QQuickWindow *window, QOpenGLContext *context);
+
     TexturesCache cache;
+    //atlases are parented to their OpenGL context, and go away with it.
+    //Each window with its own render thread looks up its atlas, hence the mutex
+    QMutex atlasesMutex;
+    QHash<QOpenGLContext*, QPointer<TextureAtlas> > atlases;
 };
 
+TextureAtlas *ImageTexturesCachePrivate::atlas(QQuickWindow *window, QOpenGLContext *context)
+{
+    QMutexLocker locker(&atlasesMutex);
+    QPointer<TextureAtlas> &atlas = atlases[context];
+    if (!atlas) {
+        atlas = new TextureAtlas(window, context);
+    }
+    //only used by the thread of its context from now on
+    return atlas;
+}
+
+QSGTexture *ImageTexturesCachePrivate::createTexture(QQuickWindow *window, const QImage &image, QQuickWindow::CreateTextureOptions options)
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+
+    if ((options & QQuickWindow::TextureCanUseAtlas) && !(options & QQuickWindow::TextureHasMipmaps)
+        && context && window->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL
+        && TextureAtlas::accepts(image)) {
+        if (QSGTexture *texture = atlas(window, context)->create(image)) {
+            return texture;
+        }
+    }
+
+    return window->createTextureFromImage(image, options);
+}
+
 ImageTexturesCache::ImageTexturesCache()
     : d(new ImageTexturesCachePrivate)
 {
@@ -51,7 +90,7 @@ QSharedPointer<QSGTexture> ImageTexturesCache::loadTexture(QQuickWindow *window,
                 d->cache.remove(id);
             delete texture;
         };
-        texture = QSharedPointer<QSGTexture>(window->createTextureFromImage(image, options), cleanAndDelete);
+        texture = QSharedPointer<QSGTexture>(d->createTexture(window, image, options), cleanAndDelete);
         (d->cache)[id][window] = texture.toWeakRef();
     }
 
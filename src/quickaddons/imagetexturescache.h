@@ -39,6 +39,10 @@ class ImageTexturesCachePrivate;
  * Keeps track of all the created textures in a map between the QImage::cacheKey() and
  * the cached texture until it gets de-referenced.
  *
+ * Small images (such as icons) requested with QQuickWindow::TextureCanUseAtlas
+ * are packed in a shared atlas owned by the cache, so the scene graph
+ * can batch the nodes using them in few draw calls.
+ *
  * @see ManagedTextureNode
  */
 class QUICKADDONS_EXPORT ImageTexturesCache
@@ -0,0 +1,288 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "textureatlas_p.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QDebug>
+
+#include <cstring>
+
+// anything bigger than a 64x64 icon at 2x goes in its own texture
+static const int s_maxItemSize = 128;
+static const int s_defaultPageSize = 1024;
+
+// every image is padded with a copy of its border, so linear filtering
+// never samples the neighbours in the page
+static const int s_padding = 1;
+
+static QImage paddedImage(const QImage &source)
+{
+    const QImage image = source.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+    const int w = image.width();
+    const int h = image.height();
+
+    QImage padded(w + 2 * s_padding, h + 2 * s_padding, QImage::Format_RGBA8888_Premultiplied);
+    for (int y = 0; y < padded.height(); ++y) {
+        const quint32 *src = reinterpret_cast<const quint32 *>(image.constScanLine(qBound(0, y - s_padding, h - 1)));
+        quint32 *dst = reinterpret_cast<quint32 *>(padded.scanLine(y));
+        dst[0] = src[0];
+        memcpy(dst + s_padding, src, w * sizeof(quint32));
+        dst[w + s_padding] = src[w - 1];
+    }
+    return padded;
+}
+
+TextureAtlasPage::TextureAtlasPage(QOpenGLContext *context, const QSize &size)
+    : m_context(context),
+      m_textureId(0),
+      m_size(size),
+      m_liveCount(0)
+{
+    QOpenGLFunctions *f = m_context->functions();
+    f->glGenTextures(1, &m_textureId);
+    f->glBindTexture(GL_TEXTURE_2D, m_textureId);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    f->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_size.width(), m_size.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+}
+
+TextureAtlasPage::~TextureAtlasPage()
+{
+    //the context may be gone already, in which case it took the texture with it
+    if (m_textureId && QOpenGLContext::currentContext() == m_context) {
+        m_context->functions()->glDeleteTextures(1, &m_textureId);
+    }
+}
+
+bool TextureAtlasPage::allocate(const QSize &size, QRect *rect, int *shelf)
+{
+    const int w = size.width() + 2 * s_padding;
+    const int h = size.height() + 2 * s_padding;
+
+    //first fit on an existing shelf, not wasting more than half of its height
+    for (int i = 0; i < m_shelves.count(); ++i) {
+        Shelf &s = m_shelves[i];
+        if (s.height >= h && s.height <= h * 3 / 2 && s.x + w <= m_size.width()) {
+            *rect = QRect(s.x, s.y, w, h);
+            *shelf = i;
+            s.x += w;
+            ++s.liveCount;
+            ++m_liveCount;
+            return true;
+        }
+    }
+
+    const int y = m_shelves.isEmpty() ? 0 : m_shelves.last().y + m_shelves.last().height;
+    if (y + h > m_size.height() || w > m_size.width()) {
+        return false;
+    }
+
+    m_shelves.append({y, h, w, 1});
+    *rect = QRect(0, y, w, h);
+    *shelf = m_shelves.count() - 1;
+    ++m_liveCount;
+    return true;
+}
+
+void TextureAtlasPage::release(int shelf)
+{
+    Shelf &s = m_shelves[shelf];
+    --s.liveCount;
+    --m_liveCount;
+
+    if (s.liveCount > 0) {
+        return;
+    }
+
+    //the whole shelf is free again
+    s.x = 0;
+
+    //give back trailing empty shelves, so the space can be reused with a different height
+    while (!m_shelves.isEmpty() && m_shelves.last().liveCount == 0) {
+        m_shelves.removeLast();
+    }
+}
+
+void TextureAtlasPage::upload(const QRect &rect, const QImage &image)
+{
+    QOpenGLFunctions *f = m_context->functions();
+    f->glBindTexture(GL_TEXTURE_2D, m_textureId);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(), GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+}
+
+bool TextureAtlasPage::isEmpty() const
+{
+    return m_liveCount == 0;
+}
+
+uint TextureAtlasPage::textureId() const
+{
+    return m_textureId;
+}
+
+QSize TextureAtlasPage::size() const
+{
+    return m_size;
+}
+
+
+
+AtlasTexture::AtlasTexture(TextureAtlas *atlas, TextureAtlasPage *page, int shelf, const QRect &rect, const QImage &image)
+    : m_atlas(atlas),
+      m_page(page),
+      m_shelf(shelf),
+      m_textureId(page->textureId()),
+      m_normalizedRect((rect.x() + s_padding) / qreal(page->size().width()),
+                       (rect.y() + s_padding) / qreal(page->size().height()),
+                       image.width() / qreal(page->size().width()),
+                       image.height() / qreal(page->size().height())),
+      m_image(image),
+      m_standalone(nullptr)
+{
+}
+
+AtlasTexture::~AtlasTexture()
+{
+    //if the atlas is gone, so are its pages
+    if (m_atlas) {
+        m_page->release(m_shelf);
+    }
+    delete m_standalone;
+}
+
+int AtlasTexture::textureId() const
+{
+    return m_atlas ? m_textureId : 0;
+}
+
+QSize AtlasTexture::textureSize() const
+{
+    return m_image.size();
+}
+
+bool AtlasTexture::hasAlphaChannel() const
+{
+    return m_image.hasAlphaChannel();
+}
+
+bool AtlasTexture::hasMipmaps() const
+{
+    return false;
+}
+
+bool AtlasTexture::isAtlasTexture() const
+{
+    return true;
+}
+
+QRectF AtlasTexture::normalizedTextureSubRect() const
+{
+    return m_normalizedRect;
+}
+
+QSGTexture *AtlasTexture::removedFromAtlas() const
+{
+    if (!m_standalone && m_atlas && m_atlas->window()) {
+        m_standalone = m_atlas->window()->createTextureFromImage(m_image);
+    }
+    return m_standalone;
+}
+
+void AtlasTexture::bind()
+{
+    QOpenGLContext::currentContext()->functions()->glBindTexture(GL_TEXTURE_2D, textureId());
+    updateBindOptions();
+}
+
+
+
+TextureAtlas::TextureAtlas(QQuickWindow *window, QOpenGLContext *context)
+    : QObject(context),
+      m_window(window),
+      m_context(context),
+      m_pageSize(s_defaultPageSize, s_defaultPageSize)
+{
+    int maxTextureSize = 0;
+    m_context->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    if (maxTextureSize > 0) {
+        m_pageSize = m_pageSize.boundedTo(QSize(maxTextureSize, maxTextureSize));
+    }
+
+    //the context is still current when this is emitted, so it's the last chance to free our pages;
+    //textures still out there will notice through their QPointer
+    connect(context, &QOpenGLContext::aboutToBeDestroyed, this, [this]() {
+        delete this;
+    }, Qt::DirectConnection);
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    qDeleteAll(m_pages);
+}
+
+bool TextureAtlas::accepts(const QImage &image)
+{
+    return !image.isNull() && image.width() <= s_maxItemSize && image.height() <= s_maxItemSize;
+}
+
+QSGTexture *TextureAtlas::create(const QImage &image)
+{
+    compact();
+
+    QRect rect;
+    int shelf = -1;
+    TextureAtlasPage *page = nullptr;
+    for (TextureAtlasPage *candidate : qAsConst(m_pages)) {
+        if (candidate->allocate(image.size(), &rect, &shelf)) {
+            page = candidate;
+            break;
+        }
+    }
+
+    if (!page) {
+        page = new TextureAtlasPage(m_context, m_pageSize);
+        if (!page->textureId() || !page->allocate(image.size(), &rect, &shelf)) {
+            delete page;
+            return nullptr;
+        }
+        m_pages.append(page);
+    }
+
+    page->upload(rect, paddedImage(image));
+    return new AtlasTexture(this, page, shelf, rect, image);
+}
+
+QQuickWindow *TextureAtlas::window() const
+{
+    return m_window.data();
+}
+
+void TextureAtlas::compact()
+{
+    //keep the first page around even if empty, it's going to be needed again soon
+    for (int i = m_pages.count() - 1; i > 0; --i) {
+        if (m_pages[i]->isEmpty()) {
+            delete m_pages.takeAt(i);
+        }
+    }
+}
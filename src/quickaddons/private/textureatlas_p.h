@@ -0,0 +1,129 @@
+/*
+ *   Copyright 2019 The KDE Community
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU Library General Public License as
+ *   published by the Free Software Foundation; either version 2, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details
+ *
+ *   You should have received a copy of the GNU Library General Public
+ *   License along with this program; if not, write to the
+ *   Free Software Foundation, Inc.,
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TEXTUREATLAS_P_H
+#define TEXTUREATLAS_P_H
+
+#include <QImage>
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QSGTexture>
+#include <QVector>
+
+class QOpenGLContext;
+class TextureAtlas;
+
+/**
+ * One fixed size OpenGL texture of the atlas, packed in horizontal shelves.
+ */
+class TextureAtlasPage
+{
+public:
+    struct Shelf {
+        int y;
+        int height;
+        int x;
+        int liveCount;
+    };
+
+    TextureAtlasPage(QOpenGLContext *context, const QSize &size);
+    ~TextureAtlasPage();
+
+    bool allocate(const QSize &size, QRect *rect, int *shelf);
+    void release(int shelf);
+    void upload(const QRect &rect, const QImage &image);
+
+    bool isEmpty() const;
+    uint textureId() const;
+    QSize size() const;
+
+private:
+    QOpenGLContext *m_context;
+    uint m_textureId;
+    QSize m_size;
+    QVector<Shelf> m_shelves;
+    int m_liveCount;
+};
+
+/**
+ * A sub-rect of a TextureAtlasPage, as handed out by ImageTexturesCache.
+ */
+class AtlasTexture : public QSGTexture
+{
+public:
+    AtlasTexture(TextureAtlas *atlas, TextureAtlasPage *page, int shelf, const QRect &rect, const QImage &image);
+    ~AtlasTexture() override;
+
+    int textureId() const override;
+    QSize textureSize() const override;
+    bool hasAlphaChannel() const override;
+    bool hasMipmaps() const override;
+    bool isAtlasTexture() const override;
+    QRectF normalizedTextureSubRect() const override;
+    QSGTexture *removedFromAtlas() const override;
+    void bind() override;
+
+private:
+    QPointer<TextureAtlas> m_atlas;
+    TextureAtlasPage *m_page;
+    const int m_shelf;
+    const uint m_textureId;
+    const QRectF m_normalizedRect;
+    const QImage m_image;
+    mutable QSGTexture *m_standalone;
+};
+
+/**
+ * Multi-page atlas for small images, living as long as the OpenGL context
+ * it has been created for.
+ *
+ * Pages are added when the existing ones are full, and freed space is given
+ * back to the shelves as soon as the last texture of a shelf goes away.
+ * Pages left empty are deleted at the next allocation rather than at release
+ * time, when the context is not guaranteed to be current.
+ */
+class TextureAtlas : public QObject
+{
+public:
+    explicit TextureAtlas(QQuickWindow *window, QOpenGLContext *context);
+    ~TextureAtlas() override;
+
+    /**
+     * @returns whether @p image is small enough to be put in the atlas
+     */
+    static bool accepts(const QImage &image);
+
+    /**
+     * @returns a new texture for @p image or nullptr if it couldn't be allocated
+     */
+    QSGTexture *create(const QImage &image);
+
+    QQuickWindow *window() const;
+
+private:
+    void compact();
+
+    QPointer<QQuickWindow> m_window;
+    QOpenGLContext *m_context;
+    QVector<TextureAtlasPage *> m_pages;
+    QSize m_pageSize;
+};
+
+#endif
@@ -14,6 +14,16 @@ Rectangle {
         icon: "rating"
         width: 8
         height: 8
+        asynchronous: asyncCheckBox.checked
+    }
+
+    CheckBox {
+        id: asyncCheckBox
+        anchors {
+            bottom: parent.bottom
+            right: parent.right
+        }
+        text: "Asynchronous"
     }
 
     Button {